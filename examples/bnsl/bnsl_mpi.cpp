@@ -28,7 +28,7 @@ const int N = 2;
 using task_type = bnsl_task<N>;
 using partitioner_type = bnsl_hyper_partitioner<N>;
 
-void bnsl_search(MPI_Comm Comm) {
+void bnsl_search(MPI_Comm Comm, bool polling) {
     int rank, size;
 
     MPI_Comm_rank(Comm, &rank);
@@ -37,8 +37,12 @@ void bnsl_search(MPI_Comm Comm) {
     task_type t;
     bnsl_state<task_type::set_type> st;
 
+    // without MPI_THREAD_MULTIPLE requests are served by polling
+    scool::mpi_config cfg;
+    if (polling) cfg.progress = scool::mpi_config::POLLING;
+
     // bnsl tasks are never unique, they form poset lattice
-    scool::mpi_executor<task_type, bnsl_state<task_type::set_type>, partitioner_type, false> exec(Comm);
+    scool::mpi_executor<task_type, bnsl_state<task_type::set_type>, partitioner_type, false> exec(Comm, -1, cfg);
 
     //exec.log() = std::move(mpix::Logger(rank, "mpi"));
     exec.log().level(mpix::Logger::DEBUG);
@@ -65,11 +69,17 @@ int main(int argc, char* argv[]) {
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
-    if (tlevel != MPI_THREAD_MULTIPLE) {
+    if (tlevel < MPI_THREAD_FUNNELED) {
         if (rank == 0) std::cout << "error: insufficient threading support in MPI" << std::endl;
         return MPI_Finalize();
     }
 
+    bool polling = (tlevel != MPI_THREAD_MULTIPLE);
+
+    if (polling && (rank == 0)) {
+        std::cout << "warning: no MPI_THREAD_MULTIPLE support, using polling progress" << std::endl;
+    }
+
     if (argc != 3) {
         if (rank == 0) std::cout << "usage: bnsl_mpi n mpsfile" << std::endl;
         return MPI_Finalize();
@@ -90,7 +100,7 @@ int main(int argc, char* argv[]) {
         }
 
         // let's go searching
-        bnsl_search(MPI_COMM_WORLD);
+        bnsl_search(MPI_COMM_WORLD, polling);
     } else {
         if (rank == 0) std::cout << "error: " << res.second << std::endl;
     }
@@ -18,6 +18,8 @@
 #include <ostream>
 #include <vector>
 
+#include <archive.hpp>
+
 #include "bit_util.hpp"
 #include "limits.hpp"
 
@@ -34,7 +36,7 @@ template <typename set_type> struct bnsl_state {
         }
     } // operator+=
 
-    bool operator==(const bnsl_state& st) const { return (tid == st.tid); }
+    bool operator==(const bnsl_state& st) const { return (tid == st.tid) && (score == st.score); }
 
     void print(std::ostream& os) const {
         os << "score: " << score << ", order:";
@@ -69,4 +71,16 @@ inline std::istream& operator>>(std::istream& is, bnsl_state<set_type>& st) {
     return is;
 } // operator>>
 
+template <typename set_type>
+inline scool::archive::writer& operator<<(scool::archive::writer& ar, const bnsl_state<set_type>& st) {
+    ar.write(&st.tid, sizeof(st.tid));
+    return ar << st.score << st.path;
+} // operator<<
+
+template <typename set_type>
+inline scool::archive::reader& operator>>(scool::archive::reader& ar, bnsl_state<set_type>& st) {
+    ar.read(&st.tid, sizeof(st.tid));
+    return ar >> st.score >> st.path;
+} // operator>>
+
 #endif // BNSL_STATE_HPP
@@ -26,7 +26,7 @@
 #include "qap_task.hpp"
 
 
-void qap_search(MPI_Comm Comm) {
+void qap_search(MPI_Comm Comm, bool polling) {
     int rank;
     MPI_Comm_rank(Comm, &rank);
     std::vector<int> res (qap_task::n_);
@@ -36,7 +36,14 @@ void qap_search(MPI_Comm Comm) {
     qap_task t(std::begin(res), std::end(res));
     qap_state st(qap_task::compute_cost(t.p_), t.p_);
 
-    scool::mpi_executor<qap_task, qap_state, qap_partitioner, false> exec(Comm);
+    // share incumbent between ranks during superstep
+    scool::mpi_config cfg;
+    cfg.incumbent_channel = true;
+
+    // without MPI_THREAD_MULTIPLE requests are served by polling
+    if (polling) cfg.progress = scool::mpi_config::POLLING;
+
+    scool::mpi_executor<qap_task, qap_state, qap_partitioner, false> exec(Comm, -1, cfg);
 
     //exec.log() = std::move(mpix::Logger(rank, "mpi"));
     exec.log().level(mpix::Logger::DEBUG);
@@ -74,18 +81,24 @@ int main(int argc, char* argv[]) {
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
-    if (tlevel != MPI_THREAD_MULTIPLE) {
+    if (tlevel < MPI_THREAD_FUNNELED) {
         if (rank == 0) std::cout << "error: insufficient threading support in MPI" << std::endl;
         return MPI_Finalize();
     }
 
+    bool polling = (tlevel != MPI_THREAD_MULTIPLE);
+
+    if (polling && (rank == 0)) {
+        std::cout << "warning: no MPI_THREAD_MULTIPLE support, using polling progress" << std::endl;
+    }
+
     if (argc != 2) {
         if (rank == 0) std::cout << "usage: qap_mpi qaplib_instance" << std::endl;
         return MPI_Finalize();
     }
 
     if (read_qaplib_instance(argv[1], qap_task::n_, qap_task::F_, qap_task::D_)) {
-        qap_search(MPI_COMM_WORLD);
+        qap_search(MPI_COMM_WORLD, polling);
     } else {
         if (rank == 0) std::cout << "error: could not read instance" << std::endl;
     }
@@ -16,11 +16,14 @@
 #ifndef QAP_STATE_HPP
 #define QAP_STATE_HPP
 
+#include <algorithm>
 #include <istream>
 #include <limits>
 #include <ostream>
 #include <vector>
 
+#include <archive.hpp>
+
 
 struct qap_state {
     qap_state() = default;
@@ -33,8 +36,15 @@ struct qap_state {
             best_cost = st.best_cost;
             best_solution = st.best_solution;
         }
+        limit = std::min(limit, st.limit);
     } // operator+=
 
+    // bound used for pruning
+    int bound() const { return std::min(best_cost, limit); }
+
+    // tightens bound with the incumbent found by other rank
+    void bound(int v) { limit = std::min(limit, v); }
+
     bool operator==(const qap_state& st) const { return (st.best_cost == best_cost); }
 
     void print(std::ostream& os) const {
@@ -45,6 +55,9 @@ struct qap_state {
 
     int best_cost = std::numeric_limits<int>::max();
     std::vector<int> best_solution;
+
+    // pruning limit, not part of the reduced state
+    int limit = std::numeric_limits<int>::max();
 }; // qap_state
 
 inline std::ostream& operator<<(std::ostream& os, const qap_state& st) {
@@ -64,4 +77,12 @@ inline std::istream& operator>>(std::istream& is, qap_state& st) {
     return is;
 } // operator>>
 
+inline scool::archive::writer& operator<<(scool::archive::writer& ar, const qap_state& st) {
+    return ar << st.best_cost << st.best_solution;
+} // operator<<
+
+inline scool::archive::reader& operator>>(scool::archive::reader& ar, qap_state& st) {
+    return ar >> st.best_cost >> st.best_solution;
+} // operator>>
+
 #endif // QAP_STATE_HPP
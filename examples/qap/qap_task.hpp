@@ -20,6 +20,8 @@
 #include <ostream>
 #include <vector>
 
+#include <archive.hpp>
+
 #include "libhungarian/hungarian.hpp"
 
 
@@ -32,6 +34,7 @@ public:
 
     solution_type p_;
     int level_ = 0;
+    int bound_ = 0; // lower bound, computed when task is created
 
     qap_task() = default;
 
@@ -39,6 +42,9 @@ public:
     qap_task(Iter first, Iter last, int l = 0) : p_(first, last), level_(l) { }
 
 
+    // tasks with lower bound are more promising
+    int priority() const { return bound_; }
+
     template <typename ContextType, typename StateType>
     void process(ContextType& ctx, StateType& st) const {
         if (level_ == n_ - 1) {
@@ -48,21 +54,19 @@ public:
                 st.best_cost = cost;
                 st.best_solution = p_;
             }
-        } else {
-            int lb = compute_lower_bound(p_, level_);
-
-            if (lb <= st.best_cost) {
-                qap_task t;
-                t.level_ = level_ + 1;
-                t.p_ = p_;
-                // now we generate tasks
-                for (int i = level_; i < n_; ++i) {
-                    std::swap(t.p_[level_], t.p_[i]);
-                    ctx.push(t);
-                    std::swap(t.p_[level_], t.p_[i]);
-                }
-            } // if lb
-        } // else
+        } else if (bound_ <= st.bound()) {
+            // incumbent could improve since task was created
+            qap_task t;
+            t.level_ = level_ + 1;
+            t.p_ = p_;
+            // now we generate tasks, bounding them right away
+            for (int i = level_; i < n_; ++i) {
+                std::swap(t.p_[level_], t.p_[i]);
+                t.bound_ = (t.level_ == n_ - 1) ? compute_cost(t.p_) : compute_lower_bound(t.p_, t.level_);
+                if (t.bound_ <= st.bound()) ctx.push(t);
+                std::swap(t.p_[level_], t.p_[i]);
+            }
+        } // if bound_
     } // process
 
     void merge(const qap_task&) { }
@@ -158,6 +162,7 @@ inline std::ostream& operator<<(std::ostream& os, const qap_task& t) {
     int n = t.p_.size();
     os.write(reinterpret_cast<const char*>(&n), sizeof(n));
     os.write(reinterpret_cast<const char*>(&t.level_), sizeof(t.level_));
+    os.write(reinterpret_cast<const char*>(&t.bound_), sizeof(t.bound_));
     os.write(reinterpret_cast<const char*>(t.p_.data()), n * sizeof(int));
     return os;
 } // operator<<
@@ -166,11 +171,20 @@ inline std::istream& operator>>(std::istream& is, qap_task& t) {
     int n = 0;
     is.read(reinterpret_cast<char*>(&n), sizeof(n));
     is.read(reinterpret_cast<char*>(&t.level_), sizeof(t.level_));
+    is.read(reinterpret_cast<char*>(&t.bound_), sizeof(t.bound_));
     t.p_.resize(n);
     is.read(reinterpret_cast<char*>(t.p_.data()), n * sizeof(int));
     return is;
 } // operator>>
 
+inline scool::archive::writer& operator<<(scool::archive::writer& ar, const qap_task& t) {
+    return ar << t.level_ << t.bound_ << t.p_;
+} // operator<<
+
+inline scool::archive::reader& operator>>(scool::archive::reader& ar, qap_task& t) {
+    return ar >> t.level_ >> t.bound_ >> t.p_;
+} // operator>>
+
 
 namespace std {
   template <> struct hash<qap_task> {
@@ -34,7 +34,7 @@ template <typename set_type> struct bnsl_state {
         }
     } // operator+=
 
-    bool operator==(const bnsl_state& st) const { return (tid == st.tid); }
+    bool operator==(const bnsl_state& st) const { return (tid == st.tid) && (score == st.score); }
 
     void print(std::ostream& os) const {
         os << "score: " << score << ", order:";
@@ -28,6 +28,7 @@ public:
     // The operator is used to perform reduction of local views of the *toy_state*,
     // to obtain a consistent global view. Note that commutative property implies
     // that order in which the operator is used by the runtime system is not defined.
+    // If *toy_state* is trivially copyable, MPI executors reduce it with a single MPI_Allreduce.
     //
     // Parameters:
     // st - toy_state to reduce with, i.e., the expected behavior is *this* = *this* + *st*.
@@ -37,7 +38,9 @@ public:
 
     // Function: operator==
     // Implements equality comparison.
-    // The routine is critical as it enables efficient distribution of the global state.
+    // The routine is critical as it enables efficient distribution of the global state:
+    // equal states are treated as interchangeable, and the global state is not broadcast
+    // if it compares equal to the one from the previous superstep.
     void operator==(const toy_state& st) const;
 
 }; // class toy_state
@@ -27,7 +27,7 @@
 #include "tsp_task.hpp"
 
 
-void tsp_search(MPI_Comm Comm) {
+void tsp_search(MPI_Comm Comm, bool one_sided) {
     int size, rank;
 
     MPI_Comm_size(Comm, &size);
@@ -50,7 +50,14 @@ void tsp_search(MPI_Comm Comm) {
 
     tsp_state st;
 
-    scool::mpi_executor<tsp_task, tsp_state, tsp_partitioner, true> exec(Comm);
+    // tsp tasks are short, steals should cost a single message
+    scool::mpi_config cfg;
+    cfg.protocol = scool::mpi_config::SINGLE_MESSAGE;
+
+    // without MPI_THREAD_MULTIPLE there can be no listener thread
+    if (one_sided) cfg.stealing = scool::mpi_config::ONE_SIDED;
+
+    scool::mpi_executor<tsp_task, tsp_state, tsp_partitioner, true> exec(Comm, -1, cfg);
 
     //exec.log() = std::move(mpix::Logger(rank, "mpi"));
     exec.log().level(mpix::Logger::DEBUG);
@@ -77,9 +84,10 @@ int main(int argc, char* argv[]) {
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
-    if (tlevel != MPI_THREAD_MULTIPLE) {
-        if (rank == 0) std::cout << "error: insufficient threading support in MPI" << std::endl;
-        return MPI_Finalize();
+    bool one_sided = (tlevel != MPI_THREAD_MULTIPLE);
+
+    if (one_sided && (rank == 0)) {
+        std::cout << "warning: insufficient threading support in MPI, using one-sided stealing" << std::endl;
     }
 
     if (argc != 3) {
@@ -95,7 +103,7 @@ int main(int argc, char* argv[]) {
     }
 
     if (read_tsp_instance(argv[2], tsp_task::n_, tsp_task::D_, tsp_task::b_)) {
-        tsp_search(MPI_COMM_WORLD);
+        tsp_search(MPI_COMM_WORLD, one_sided);
     } else {
         if (rank == 0) std::cout << "error: could not read instance" << std::endl;
     }
@@ -16,11 +16,14 @@
 #ifndef TSP_STATE_HPP
 #define TSP_STATE_HPP
 
+#include <algorithm>
 #include <istream>
 #include <limits>
 #include <ostream>
 #include <vector>
 
+#include <archive.hpp>
+
 
 struct tsp_state {
     tsp_state() = default;
@@ -32,8 +35,15 @@ struct tsp_state {
             best_cost = st.best_cost;
             best_solution = st.best_solution;
         }
+        limit = std::min(limit, st.limit);
     } // operator+=
 
+    // bound used for pruning
+    float bound() const { return std::min(best_cost, limit); }
+
+    // tightens bound with the incumbent found by other rank
+    void bound(float v) { limit = std::min(limit, v); }
+
     bool operator==(const tsp_state& st) const { return (st.best_cost == best_cost); }
 
     void print(std::ostream& os) const {
@@ -46,6 +56,9 @@ struct tsp_state {
     float best_cost = std::numeric_limits<float>::max();
     std::vector<int> best_solution;
 
+    // pruning limit, not part of the reduced state
+    float limit = std::numeric_limits<float>::max();
+
 }; // tsp_state
 
 inline std::ostream& operator<<(std::ostream& os, const tsp_state& st) {
@@ -65,4 +78,12 @@ inline std::istream& operator>>(std::istream& is, tsp_state& st) {
     return is;
 } // operator>>
 
+inline scool::archive::writer& operator<<(scool::archive::writer& ar, const tsp_state& st) {
+    return ar << st.best_cost << st.best_solution;
+} // operator<<
+
+inline scool::archive::reader& operator>>(scool::archive::reader& ar, tsp_state& st) {
+    return ar >> st.best_cost >> st.best_solution;
+} // operator>>
+
 #endif // TSP_STATE_HPP
@@ -19,6 +19,8 @@
 #include <ostream>
 #include <vector>
 
+#include <archive.hpp>
+
 
 class tsp_task {
 public:
@@ -51,7 +53,7 @@ public:
 
                 auto cost = compute_cost(t.p_);
 
-                if (cost < st.best_cost) {
+                if (cost < st.bound()) {
                     st.best_cost = cost;
                     st.best_solution = t.p_;
 
@@ -117,6 +119,19 @@ inline std::istream& operator>>(std::istream& is, tsp_task& t) {
     return is;
 } // operator>>
 
+inline scool::archive::writer& operator<<(scool::archive::writer& ar, const tsp_task& t) {
+    ar.write(t.i_range_, 2 * sizeof(int));
+    ar.write(t.p_.data(), tsp_task::n_ * sizeof(int));
+    return ar;
+} // operator<<
+
+inline scool::archive::reader& operator>>(scool::archive::reader& ar, tsp_task& t) {
+    ar.read(t.i_range_, 2 * sizeof(int));
+    t.p_.resize(tsp_task::n_);
+    ar.read(t.p_.data(), tsp_task::n_ * sizeof(int));
+    return ar;
+} // operator>>
+
 
 namespace std {
   template <> struct hash<tsp_task> {
@@ -0,0 +1,317 @@
+/***
+ *  $Id$
+ **
+ *  File: archive.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef ARCHIVE_HPP
+#define ARCHIVE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <type_traits>
+#include <vector>
+
+
+namespace scool {
+
+  namespace archive {
+
+    // Type: size_type
+    // Type used to encode sizes (e.g., frame lengths) in the archive.
+    using size_type = std::uint64_t;
+
+
+    // Class: writer
+    // Binary archive appending to a contiguous buffer.
+    // All writes are bulk copies, there is no per-byte overhead.
+    class writer {
+    public:
+        // Function: writer
+        // Creates archive that appends to *buf*.
+        explicit writer(std::vector<char>& buf) : buf_(buf) { }
+
+        // Function: write
+        // Appends *n* raw bytes from *p*.
+        void write(const void* p, std::size_t n) {
+            auto first = static_cast<const char*>(p);
+            buf_.insert(std::end(buf_), first, first + n);
+        } // write
+
+        // Function: open_frame
+        // Starts a size-prefixed frame.
+        //
+        // Returns:
+        //   the handle that must be passed to <close_frame>.
+        std::size_t open_frame() {
+            size_type n = 0;
+            auto pos = buf_.size();
+            write(&n, sizeof(n));
+            return pos;
+        } // open_frame
+
+        // Function: close_frame
+        // Finalizes frame started with <open_frame>, i.e., stores its length.
+        void close_frame(std::size_t pos) {
+            size_type n = buf_.size() - pos - sizeof(size_type);
+            std::memcpy(buf_.data() + pos, &n, sizeof(n));
+        } // close_frame
+
+        // Function: size
+        // Returns: the number of bytes in the underlying buffer.
+        std::size_t size() const { return buf_.size(); }
+
+        std::vector<char>& buffer() { return buf_; }
+
+    private:
+        std::vector<char>& buf_;
+
+    }; // class writer
+
+
+    // Class: reader
+    // Binary archive reading from a contiguous buffer.
+    // The buffer must outlive the reader.
+    class reader {
+    public:
+        reader(const char* data, std::size_t n) : first_(data), last_(data + n) { }
+
+        explicit reader(const std::vector<char>& buf) : reader(buf.data(), buf.size()) { }
+
+        // Function: read
+        // Extracts *n* raw bytes into *p*.
+        void read(void* p, std::size_t n) {
+            if (n > size()) throw std::runtime_error("archive underflow");
+            std::memcpy(p, first_, n);
+            first_ += n;
+        } // read
+
+        // Function: skip
+        // Ignores next *n* bytes.
+        void skip(std::size_t n) {
+            if (n > size()) throw std::runtime_error("archive underflow");
+            first_ += n;
+        } // skip
+
+        // Function: frame
+        // Extracts a frame written by <writer::open_frame>.
+        //
+        // Returns:
+        //   the reader restricted to the frame content.
+        reader frame() {
+            size_type n = 0;
+            read(&n, sizeof(n));
+            reader r(first_, n);
+            skip(n);
+            return r;
+        } // frame
+
+        bool empty() const { return (first_ == last_); }
+
+        std::size_t size() const { return last_ - first_; }
+
+        const char* data() const { return first_; }
+
+    private:
+        const char* first_;
+        const char* last_;
+
+    }; // class reader
+
+
+    // stream buffers used to support types providing only iostream operators
+    class ostreambuf : public std::streambuf {
+    public:
+        explicit ostreambuf(writer& ar) : ar_(ar) { }
+
+    protected:
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            ar_.write(s, n);
+            return n;
+        } // xsputn
+
+        int_type overflow(int_type c = traits_type::eof()) override {
+            if (c != traits_type::eof()) {
+                char x = traits_type::to_char_type(c);
+                ar_.write(&x, 1);
+            }
+            return c;
+        } // overflow
+
+    private:
+        writer& ar_;
+
+    }; // class ostreambuf
+
+    class istreambuf : public std::streambuf {
+    public:
+        explicit istreambuf(const reader& ar) {
+            auto first = const_cast<char*>(ar.data());
+            this->setg(first, first, first + ar.size());
+        } // istreambuf
+
+        std::size_t consumed() const { return this->gptr() - this->eback(); }
+
+    }; // class istreambuf
+
+
+    // serialization of arithmetic types and their vectors
+    template <typename T> requires std::is_arithmetic_v<T>
+    inline writer& operator<<(writer& ar, T x) {
+        ar.write(&x, sizeof(x));
+        return ar;
+    } // operator<<
+
+    template <typename T> requires std::is_arithmetic_v<T>
+    inline reader& operator>>(reader& ar, T& x) {
+        ar.read(&x, sizeof(x));
+        return ar;
+    } // operator>>
+
+    template <typename T, typename Alloc> requires std::is_arithmetic_v<T>
+    inline writer& operator<<(writer& ar, const std::vector<T, Alloc>& v) {
+        size_type n = v.size();
+        ar.write(&n, sizeof(n));
+        ar.write(v.data(), n * sizeof(T));
+        return ar;
+    } // operator<<
+
+    template <typename T, typename Alloc> requires std::is_arithmetic_v<T>
+    inline reader& operator>>(reader& ar, std::vector<T, Alloc>& v) {
+        size_type n = 0;
+        ar.read(&n, sizeof(n));
+        v.resize(n);
+        ar.read(v.data(), n * sizeof(T));
+        return ar;
+    } // operator>>
+
+
+    // Concept: has_save
+    // Satisfied if *T* provides archive serialization operator<<(writer&, const T&).
+    template <typename T>
+    concept has_save = requires(writer& ar, const T& t) { ar << t; };
+
+    // Concept: has_load
+    // Satisfied if *T* provides archive deserialization operator>>(reader&, T&).
+    template <typename T>
+    concept has_load = requires(reader& ar, T& t) { ar >> t; };
+
+    // Variable: is_bitwise_v
+    // True if *T* is serialized by copying its object representation,
+    // i.e., it is trivially copyable and does not provide archive operators.
+    template <typename T>
+    inline constexpr bool is_bitwise_v = std::is_trivially_copyable_v<T> && !has_save<T> && !has_load<T>;
+
+
+    // Function: save
+    // Serializes *t* into *ar*. Trivially copyable types without archive
+    // operators are copied as is. Other types without archive operators
+    // are serialized via their std::ostream operator<<.
+    template <typename T>
+    inline void save(writer& ar, const T& t) {
+        if constexpr (is_bitwise_v<T>) ar.write(std::addressof(t), sizeof(T));
+        else if constexpr (has_save<T>) ar << t;
+        else {
+            ostreambuf ob(ar);
+            std::ostream os(&ob);
+            os << t;
+        }
+    } // save
+
+    // Function: load
+    // Deserializes *t* from *ar*. Complements <save>.
+    template <typename T>
+    inline void load(reader& ar, T& t) {
+        if constexpr (is_bitwise_v<T>) ar.read(std::addressof(t), sizeof(T));
+        else if constexpr (has_load<T>) ar >> t;
+        else {
+            istreambuf ib(ar);
+            std::istream is(&ib);
+            is >> t;
+            ar.skip(ib.consumed());
+        }
+    } // load
+
+
+    // Function: save_range
+    // Serializes [first, last) as a single frame prefixed with the number of objects.
+    template <typename Iter>
+    inline void save_range(writer& ar, Iter first, Iter last) {
+        auto pos = ar.open_frame();
+
+        size_type n = 0;
+        auto cpos = ar.size();
+        ar.write(&n, sizeof(n));
+
+        using T = std::iter_value_t<Iter>;
+
+        if constexpr (is_bitwise_v<T> && std::contiguous_iterator<Iter>) {
+            n = last - first;
+            ar.write(std::to_address(first), n * sizeof(T));
+        } else {
+            for (; first != last; ++first, ++n) save(ar, *first);
+        }
+
+        std::memcpy(ar.buffer().data() + cpos, &n, sizeof(n));
+        ar.close_frame(pos);
+    } // save_range
+
+    // Function: for_each
+    // Deserializes frame written by <save_range>, and calls *f* on each object.
+    template <typename T, typename Fun>
+    inline void for_each(reader& ar, Fun f) {
+        auto fr = ar.frame();
+
+        size_type n = 0;
+        fr.read(&n, sizeof(n));
+
+        for (size_type i = 0; i < n; ++i) {
+            T t;
+            load(fr, t);
+            f(std::move(t));
+        }
+    } // for_each
+
+    // Function: load_range
+    // Deserializes frame written by <save_range> into output iterator *out*.
+    template <typename T, typename Output>
+    inline Output load_range(reader& ar, Output out) {
+        for_each<T>(ar, [&out](T&& t) { *(out++) = std::move(t); });
+        return out;
+    } // load_range
+
+    // Function: load_range
+    // Deserializes frame written by <save_range> appending to *v*.
+    template <typename T, typename Alloc>
+    inline void load_range(reader& ar, std::vector<T, Alloc>& v) {
+        if constexpr (is_bitwise_v<T>) {
+            auto fr = ar.frame();
+
+            size_type n = 0;
+            fr.read(&n, sizeof(n));
+
+            auto pos = v.size();
+            v.resize(pos + n);
+            fr.read(v.data() + pos, n * sizeof(T));
+        } else load_range<T>(ar, std::back_inserter(v));
+    } // load_range
+
+  } // namespace archive
+
+} // namespace scool
+
+#endif // ARCHIVE_HPP
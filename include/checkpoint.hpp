@@ -0,0 +1,208 @@
+/***
+ *  $Id$
+ **
+ *  File: checkpoint.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "archive.hpp"
+
+
+namespace scool {
+
+  namespace impl {
+
+    // checkpoint file layout (all integers are 64-bit):
+    // magic, number of blocks, iteration, state size, offsets of blocks (one past the last included),
+    // global state, and blocks of tasks, each block is a sequence of archive::save_range frames,
+    // the layout is shared by all executors, so a checkpoint can be restarted by any of them
+    struct checkpoint_head {
+        static const std::uint64_t MAGIC = 0x314b434c4f4f4353ULL; // "SCOOLCK1"
+        static const std::size_t PREFIX = 4 * sizeof(std::uint64_t);
+
+        std::uint64_t nblocks = 0;
+        std::uint64_t iter = 0;
+        std::uint64_t state_size = 0;
+        std::vector<std::uint64_t> offs;
+
+        // the number of bytes that follow the prefix and precede the first block
+        std::size_t tail() const { return (nblocks + 1) * sizeof(std::uint64_t) + state_size; }
+
+    }; // struct checkpoint_head
+
+    // writes head for blocks of given sizes, offsets are relative to the beginning of file
+    template <typename State>
+    inline void write_checkpoint_head(archive::writer& ar, int iter, const State& st, const std::vector<std::uint64_t>& sizes) {
+        std::vector<char> sbuf;
+        archive::writer sar(sbuf);
+        archive::save(sar, st);
+
+        std::uint64_t nb = sizes.size();
+        std::uint64_t pos = checkpoint_head::PREFIX + (nb + 1) * sizeof(std::uint64_t) + sbuf.size();
+
+        ar << checkpoint_head::MAGIC << nb << static_cast<std::uint64_t>(iter) << static_cast<std::uint64_t>(sbuf.size());
+
+        for (auto sz : sizes) {
+            ar << pos;
+            pos += sz;
+        }
+
+        ar << pos;
+        ar.write(sbuf.data(), sbuf.size());
+    } // write_checkpoint_head
+
+    // reads fixed size prefix of head, returns false if this is not a checkpoint,
+    // or if the head does not fit in file of fsize bytes
+    inline bool read_checkpoint_prefix(archive::reader& ar, checkpoint_head& h, std::uint64_t fsize) {
+        std::uint64_t magic = 0;
+        if ((ar.size() < checkpoint_head::PREFIX) || (fsize < checkpoint_head::PREFIX)) return false;
+
+        ar >> magic;
+        if (magic != checkpoint_head::MAGIC) return false;
+
+        ar >> h.nblocks >> h.iter >> h.state_size;
+
+        // checked separately first, so that tail() does not overflow
+        if ((h.nblocks >= fsize / sizeof(std::uint64_t)) || (h.state_size > fsize)) return false;
+
+        return (checkpoint_head::PREFIX + h.tail() <= fsize);
+    } // read_checkpoint_prefix
+
+    // reads the remaining part of head that follows the prefix, returns false
+    // if blocks do not follow the head, overlap, or do not fit in file of fsize bytes
+    template <typename State>
+    inline bool read_checkpoint_tail(archive::reader& ar, checkpoint_head& h, State& st, std::uint64_t fsize) {
+        h.offs.resize(h.nblocks + 1);
+        for (auto& x : h.offs) ar >> x;
+
+        if (h.offs[0] != checkpoint_head::PREFIX + h.tail()) return false;
+
+        for (std::uint64_t b = 0; b < h.nblocks; ++b) {
+            if (h.offs[b] > h.offs[b + 1]) return false;
+        }
+
+        if (h.offs[h.nblocks] > fsize) return false;
+
+        archive::reader sar(ar.data(), h.state_size);
+        archive::load(sar, st);
+        ar.skip(h.state_size);
+
+        return true;
+    } // read_checkpoint_tail
+
+    // calls f on each task in block
+    template <typename T, typename Fun>
+    inline long long int for_each_checkpoint_task(const char* data, std::size_t n, Fun f) {
+        long long int count = 0;
+        archive::reader ar(data, n);
+
+        while (!ar.empty()) {
+            archive::for_each<T>(ar, [&](T&& t) {
+                f(std::move(t));
+                count++;
+            });
+        }
+
+        return count;
+    } // for_each_checkpoint_task
+
+    // writes buf to name, the file is replaced only if all data is written
+    inline bool write_file(const std::string& name, const std::vector<char>& buf) {
+        std::string tmp = name + ".tmp";
+
+        std::ofstream of(tmp, std::ios::binary | std::ios::trunc);
+        if (!of) return false;
+
+        of.write(buf.data(), buf.size());
+        of.close();
+
+        if (!of) return false;
+        return (std::rename(tmp.c_str(), name.c_str()) == 0);
+    } // write_file
+
+    inline bool read_file(const std::string& name, std::vector<char>& buf) {
+        std::ifstream f(name, std::ios::binary | std::ios::ate);
+        if (!f) return false;
+
+        buf.resize(f.tellg());
+        f.seekg(0);
+        f.read(buf.data(), buf.size());
+
+        return static_cast<bool>(f);
+    } // read_file
+
+    // appends [first, last) to block as a sequence of frames
+    template <typename Iter>
+    inline void save_frames(archive::writer& ar, Iter first, Iter last) {
+        const int FRAME = 1024;
+
+        while (first != last) {
+            auto it = first;
+            for (int i = 0; (i < FRAME) && (it != last); ++i) ++it;
+            archive::save_range(ar, first, it);
+            first = it;
+        }
+    } // save_frames
+
+    // writes checkpoint with a single block filled by fill(archive::writer&) using standard I/O
+    template <typename State, typename Fun>
+    inline bool save_checkpoint(const std::string& name, int iter, const State& st, Fun fill) {
+        std::vector<char> block;
+        archive::writer bar(block);
+
+        fill(bar);
+
+        std::vector<char> buf;
+        archive::writer ar(buf);
+
+        write_checkpoint_head(ar, iter, st, std::vector<std::uint64_t>{block.size()});
+        ar.write(block.data(), block.size());
+
+        return write_file(name, buf);
+    } // save_checkpoint
+
+    // reads checkpoint written by any executor, f is called on each task,
+    // returns the number of tasks or -1 if name is not a valid checkpoint
+    template <typename T, typename State, typename Fun>
+    inline long long int load_checkpoint(const std::string& name, int& iter, State& st, Fun f) {
+        std::vector<char> buf;
+        if (!read_file(name, buf)) return -1;
+
+        checkpoint_head h;
+        archive::reader ar(buf);
+
+        if (!read_checkpoint_prefix(ar, h, buf.size())) return -1;
+        if (!read_checkpoint_tail(ar, h, st, buf.size())) return -1;
+
+        iter = h.iter;
+
+        long long int count = 0;
+
+        for (std::uint64_t b = 0; b < h.nblocks; ++b) {
+            count += for_each_checkpoint_task<T>(buf.data() + h.offs[b], h.offs[b + 1] - h.offs[b], f);
+        }
+
+        return count;
+    } // load_checkpoint
+
+  } // namespace impl
+
+} // namespace scool
+
+#endif // CHECKPOINT_HPP
@@ -16,9 +16,15 @@
 #ifndef IMPL_HPP
 #define IMPL_HPP
 
+#include <algorithm>
 #include <bit>
 #include <cstdint>
 #include <deque>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <queue>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -27,6 +33,17 @@
 
 namespace scool {
 
+  // Concept: has_priority
+  // Satisfied if task type *T* exposes an arithmetic priority().
+  // Executors then process tasks of a superstep in the order of increasing priority(),
+  // e.g., lower bound in minimization, so that the incumbent improves early. Queues that
+  // are processed from the head by the owner and stolen from the tail are arranged so that
+  // both ends hold the best tasks, see sort_by_priority_two_ends.
+  template <typename T>
+  concept has_priority = requires(const T& t) {
+      requires std::is_arithmetic_v<std::remove_cvref_t<decltype(t.priority())>>;
+  };
+
   namespace impl {
 
     inline uint32_t map_to(uint32_t key, uint32_t range) {
@@ -93,9 +110,81 @@ namespace scool {
     } // add_to
 
 
+    // the frontier of superstep is complete before it is processed,
+    // hence a single sort replaces priority queue
+
+    template <typename Iter>
+    inline void sort_by_priority(Iter first, Iter last) {
+        using T = typename std::iterator_traits<Iter>::value_type;
+
+        if constexpr (has_priority<T>) {
+            std::sort(first, last, [](const T& a, const T& b) { return a.priority() < b.priority(); });
+        }
+    } // sort_by_priority
+
+    // arranges Q so that priority increases from both ends towards the middle,
+    // for queues processed from the head by owner and stolen from the tail
+    template <typename T, typename Alloc>
+    inline void sort_by_priority_two_ends(std::vector<T, Alloc>& Q) {
+        if constexpr (has_priority<T>) {
+            sort_by_priority(std::begin(Q), std::end(Q));
+
+            int n = Q.size();
+            std::vector<T, Alloc> R(n);
+
+            for (int i = 0; i < n; ++i) {
+                if (i % 2 == 0) R[i / 2] = std::move(Q[i]);
+                else R[n - 1 - i / 2] = std::move(Q[i]);
+            }
+
+            Q.swap(R);
+        }
+    } // sort_by_priority_two_ends
+
+    // calls f on each task in S in the order of priority, if task type has one
+    template <typename Container, typename Fun>
+    inline void for_each_by_priority(Container& S, Fun f) {
+        using T = typename Container::value_type;
+
+        if constexpr (has_priority<T>) {
+            // pointers keep constness of elements, e.g., in hash sets
+            std::vector<decltype(&*std::begin(S))> P;
+            P.reserve(S.size());
+
+            for (auto& t : S) P.push_back(&t);
+            std::sort(std::begin(P), std::end(P), [](auto a, auto b) { return a->priority() < b->priority(); });
+
+            for (auto* t : P) f(*t);
+        } else for (auto& t : S) f(t);
+    } // for_each_by_priority
+
+
+    // depth-first budget of a worker, bounds how deep ctx.push may process tasks in place,
+    // aligned so that per-thread budgets do not share cache lines
+    class alignas(64) dfs_budget {
+    public:
+        void limit(int depth) { max_ = depth; }
+
+        // true if a task can be processed in place, then leave must follow
+        bool enter() {
+            if (depth_ >= max_) return false;
+            depth_++;
+            return true;
+        } // enter
+
+        void leave() { depth_--; }
+
+    private:
+        int max_ = 0;
+        int depth_ = 0;
+
+    }; // class dfs_budget
+
+
   class bitmap {
   public:
-      using storage_type = unsigned char;
+      // 64-bit words, so that bulk operations and popcount work on full registers
+      using storage_type = std::uint64_t;
 
       explicit bitmap(int n = 0) { if (n != 0) resize(n); }
 
@@ -112,7 +201,7 @@ namespace scool {
       bool operator[](int n) const {
           int w = n / CAPACITY;
           int b = n - (CAPACITY * w);
-          return data_[w] & (1 << b);
+          return data_[w] & (storage_type(1) << b);
       } // operator[]
 
 
@@ -120,15 +209,34 @@ namespace scool {
       void set(int n, bool val = true) {
           int w = n / CAPACITY;
           int b = n - (CAPACITY * w);
-          data_[w] = val ? (data_[w] | (1 << b)) : (data_[w] & ~(1 << b));
+          storage_type m = storage_type(1) << b;
+          data_[w] = val ? (data_[w] | m) : (data_[w] & ~m);
       } // set
 
-      void reset() { for (auto& x : data_) x = 0; }
+      void reset() { std::fill(std::begin(data_), std::end(data_), 0); }
 
       const storage_type* storage() const { return data_.data(); }
 
       auto storage_size() const { return data_.size(); }
 
+      // word-level access
+      storage_type word(int w) const { return data_[w]; }
+
+      void OR(int w, storage_type x) { data_[w] |= x; }
+
+      // byte-level access, independent of the word size and byte order
+      int packed_size() const { return (size_ + 7) / 8; }
+
+      void pack(unsigned char* out) const {
+          int sz = packed_size();
+          for (int i = 0; i < sz; ++i) out[i] = data_[i / sizeof(storage_type)] >> (8 * (i % sizeof(storage_type)));
+      } // pack
+
+      void OR_packed(const unsigned char* in) {
+          int sz = packed_size();
+          for (int i = 0; i < sz; ++i) data_[i / sizeof(storage_type)] |= storage_type(in[i]) << (8 * (i % sizeof(storage_type)));
+      } // OR_packed
+
 
       void OR(const storage_type* d) {
           int sz = data_.size();
@@ -141,7 +249,7 @@ namespace scool {
       } // AND
 
       // returns population count of 1 bits
-      int count() {
+      int count() const {
         int c = 0;
         int sz = data_.size();
         for (int i = 0; i < sz; ++i) c += std::popcount(data_[i]);
@@ -149,13 +257,77 @@ namespace scool {
       } // count
 
   private:
-      const int CAPACITY = 8 * sizeof(storage_type);
+      static const int CAPACITY = 8 * sizeof(storage_type);
 
-      int size_;
+      int size_ = 0;
       std::vector<storage_type> data_;
 
   }; // class bitmap
 
+
+  // maps partition keys to ranks via a table of virtual partitions,
+  // keys are hashed to virtual partitions with map_to, and virtual partitions
+  // are assigned to ranks round robin, and then by rebalance
+  class partition_map {
+  public:
+      explicit partition_map(int nranks = 1, int nvparts = 1) : nranks_(nranks), owner_(nvparts) {
+          for (int i = 0; i < nvparts; ++i) owner_[i] = i % nranks;
+      } // partition_map
+
+      int size() const { return owner_.size(); }
+
+      int owner(int v) const { return owner_[v]; }
+
+      // virtual partition of key
+      int vpart(std::size_t key) const {
+          // keys from partitioners are small and dense, so we mix them first (splitmix64)
+          std::uint64_t x = key + 0x9e3779b97f4a7c15ULL;
+          x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+          x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+          x = x ^ (x >> 31);
+          return map_to(x >> 32, owner_.size());
+      } // vpart
+
+      int operator()(std::size_t key) const { return owner_[vpart(key)]; }
+
+      // assigns virtual partitions to ranks greedily: the heaviest first, to the least loaded rank,
+      // w[v] is the weight of virtual partition v, and empty partitions keep their owners,
+      // the result is deterministic, returns the number of partitions that changed owner
+      int rebalance(const std::vector<long long int>& w) {
+          std::vector<int> order(owner_.size());
+          std::iota(std::begin(order), std::end(order), 0);
+          std::stable_sort(std::begin(order), std::end(order), [&w](int a, int b) { return w[a] > w[b]; });
+
+          using load_type = std::pair<long long int, int>;
+          std::priority_queue<load_type, std::vector<load_type>, std::greater<load_type>> Q;
+
+          for (int r = 0; r < nranks_; ++r) Q.push({0, r});
+
+          int moved = 0;
+
+          for (auto v : order) {
+              if (w[v] == 0) break;
+
+              auto [l, r] = Q.top();
+              Q.pop();
+
+              if (owner_[v] != r) {
+                  owner_[v] = r;
+                  moved++;
+              }
+
+              Q.push({l + w[v], r});
+          } // for v
+
+          return moved;
+      } // rebalance
+
+  private:
+      int nranks_;
+      std::vector<int> owner_;
+
+  }; // class partition_map
+
   } // namespace impl
 
 } // namespace scool
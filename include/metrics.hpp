@@ -0,0 +1,179 @@
+/***
+ *  $Id$
+ **
+ *  File: metrics.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace scool {
+
+  // Class: hw_counters
+  // Hardware performance counters of a phase, summed over threads.
+  // Filled only when compiled with SCOOL_PERF, see perf_counters.hpp.
+  struct hw_counters {
+      long long int cycles = 0;
+      long long int instructions = 0;
+      long long int cache_misses = 0;
+      long long int branch_misses = 0;
+
+      // Function: ipc
+      double ipc() const { return (cycles > 0) ? static_cast<double>(instructions) / cycles : 0.0; }
+
+  }; // struct hw_counters
+
+  // Class: metrics
+  // Runtime metrics of a single superstep, as seen by one rank (shared memory executors use rank 0).
+  // Executors pass the record to the callback set with on_metrics(), and write it to the file
+  // set with metrics_file(), one JSON object per line. Fields that do not apply to an executor are 0.
+  // Times are in seconds.
+  struct metrics {
+      int iteration = 0;
+      int rank = 0;
+
+      long long int tasks_processed = 0; // including stolen tasks
+      long long int tasks_stolen = 0;    // received from other ranks
+      long long int tasks_pushed = 0;    // calls to ctx.push()
+      long long int tasks_merged = 0;    // pushed or received tasks merged with duplicates
+      long long int tasks_exchanged = 0; // sent to their owners
+      long long int frontier_tasks = 0;  // local tasks for the next superstep
+      long long int frontier_bytes = 0;  // sizeof(task_type) per frontier task kept in memory
+
+      long long int steal_attempts = 0;
+      long long int steal_successes = 0;
+      long long int steal_bytes = 0;     // payload of received steal answers
+
+      double time_total = 0.0;
+      double time_process = 0.0;         // local queue
+      double time_steal = 0.0;           // stealing, including processing of stolen tasks
+      double time_idle = 0.0;            // barriers
+      double time_reduce = 0.0;          // reduction of task counts and state
+      double time_broadcast = 0.0;       // broadcast of state
+      double time_exchange = 0.0;        // routing new tasks to their owners
+      double time_merge = 0.0;           // merging duplicates outside of push
+
+      // hardware counters of the timed phases, merge includes task exchange
+      hw_counters hw_process;
+      hw_counters hw_steal;
+      hw_counters hw_merge;
+      hw_counters hw_reduce;
+
+      // Function: dedup_rate
+      // Fraction of pushed tasks that were merged with duplicates.
+      double dedup_rate() const {
+          return (tasks_pushed > 0) ? static_cast<double>(tasks_merged) / tasks_pushed : 0.0;
+      } // dedup_rate
+
+  }; // struct metrics
+
+  namespace impl {
+
+    inline void write_json(std::ostream& os, const char* name, const hw_counters& c) {
+        os << '"' << name << "\":{\"cycles\":" << c.cycles << ",\"instructions\":" << c.instructions
+           << ",\"ipc\":" << c.ipc() << ",\"cache_misses\":" << c.cache_misses
+           << ",\"branch_misses\":" << c.branch_misses << "}";
+    } // write_json
+
+  } // namespace impl
+
+  // Function: write_json
+  // Writes *m* to *os* as a single line JSON object (without line break).
+  // Hardware counters are included only if they have been collected.
+  inline std::ostream& write_json(std::ostream& os, const metrics& m) {
+      auto prec = os.precision(9);
+
+      os << "{\"iteration\":" << m.iteration << ",\"rank\":" << m.rank
+         << ",\"tasks_processed\":" << m.tasks_processed << ",\"tasks_stolen\":" << m.tasks_stolen
+         << ",\"tasks_pushed\":" << m.tasks_pushed << ",\"tasks_merged\":" << m.tasks_merged
+         << ",\"tasks_exchanged\":" << m.tasks_exchanged << ",\"frontier_tasks\":" << m.frontier_tasks
+         << ",\"frontier_bytes\":" << m.frontier_bytes << ",\"dedup_rate\":" << m.dedup_rate()
+         << ",\"steal_attempts\":" << m.steal_attempts << ",\"steal_successes\":" << m.steal_successes
+         << ",\"steal_bytes\":" << m.steal_bytes << ",\"time_total\":" << m.time_total
+         << ",\"time_process\":" << m.time_process << ",\"time_steal\":" << m.time_steal
+         << ",\"time_idle\":" << m.time_idle << ",\"time_reduce\":" << m.time_reduce
+         << ",\"time_broadcast\":" << m.time_broadcast << ",\"time_exchange\":" << m.time_exchange
+         << ",\"time_merge\":" << m.time_merge;
+
+      if (m.hw_process.cycles + m.hw_steal.cycles + m.hw_merge.cycles + m.hw_reduce.cycles > 0) {
+          os << ",\"hw\":{";
+          impl::write_json(os, "process", m.hw_process);
+          os << ',';
+          impl::write_json(os, "steal", m.hw_steal);
+          os << ',';
+          impl::write_json(os, "merge", m.hw_merge);
+          os << ',';
+          impl::write_json(os, "reduce", m.hw_reduce);
+          os << '}';
+      }
+
+      os << "}";
+
+      os.precision(prec);
+      return os;
+  } // write_json
+
+  namespace impl {
+
+    // destination of metrics: user callback, and JSON Lines file
+    class metrics_sink {
+    public:
+        void callback(std::function<void(const metrics&)> f) { f_ = std::move(f); }
+
+        bool open(const std::string& name) {
+            os_.open(name, std::ios::trunc);
+            return os_.is_open();
+        } // open
+
+        bool is_open() const { return os_.is_open(); }
+
+        void call(const metrics& m) { if (f_) f_(m); }
+
+        void write(const metrics& m) {
+            write_json(os_, m) << '\n';
+            os_.flush();
+        } // write
+
+    private:
+        std::function<void(const metrics&)> f_;
+        std::ofstream os_;
+
+    }; // class metrics_sink
+
+    // per-thread event counter, aligned so that threads do not share cache lines
+    struct alignas(64) thread_counter {
+        long long int n = 0;
+    }; // struct thread_counter
+
+    // returns the total and resets counters
+    inline long long int collect(std::vector<thread_counter>& C) {
+        long long int n = 0;
+
+        for (auto& c : C) {
+            n += c.n;
+            c.n = 0;
+        }
+
+        return n;
+    } // collect
+
+  } // namespace impl
+
+} // namespace scool
+
+#endif // METRICS_HPP
@@ -0,0 +1,200 @@
+/***
+ *  $Id$
+ **
+ *  File: mpi_config.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef MPI_CONFIG_HPP
+#define MPI_CONFIG_HPP
+
+#include <cstddef>
+
+namespace scool {
+
+  // Class: mpi_config
+  // Runtime configuration of <mpi_executor>.
+  // All ranks must use the same configuration.
+  struct mpi_config {
+      // Constants: protocol_type
+      // MULTI_MESSAGE  - steal answer is sent as head, payload size and payload.
+      // SINGLE_MESSAGE - steal answer (head, tokens and payload) is sent as one message
+      //                  that the thief sizes with MPI_Probe.
+      enum protocol_type { MULTI_MESSAGE, SINGLE_MESSAGE };
+
+      // Variable: protocol
+      // Protocol used to answer steal requests (default: MULTI_MESSAGE).
+      protocol_type protocol = MULTI_MESSAGE;
+
+      // Variable: steal_requests
+      // The maximum number of outstanding steal requests a thief keeps to different victims.
+      // Values larger than 1 enable pipelined stealing, in which the next steal is issued
+      // before the current batch is processed. Pipelined stealing implies SINGLE_MESSAGE
+      // protocol (default: 1).
+      int steal_requests = 1;
+
+      // Constants: topology_type
+      // FLAT       - victims are selected uniformly at random.
+      // NODE_FIRST - victims on the same node (as reported by MPI_COMM_TYPE_SHARED) are preferred.
+      enum topology_type { FLAT, NODE_FIRST };
+
+      // Variable: steal_topology
+      // Victim selection policy (default: FLAT).
+      topology_type steal_topology = FLAT;
+
+      // Variable: remote_steal_probability
+      // In NODE_FIRST mode, the probability of selecting a remote victim
+      // while same-node victims are still available (default: 0.05).
+      float remote_steal_probability = 0.05;
+
+      // Variable: exchange_tasks
+      // If true, at the end of each superstep executors with non-unique tasks send every
+      // new task to its owner rank, as given by the partitioner, where duplicates
+      // are merged (default: true).
+      bool exchange_tasks = true;
+
+      // Variable: exchange_round_size
+      // The maximum number of bytes a rank sends in one round of task exchange.
+      // Tasks received in a round are deserialized while the next round is in flight (default: 64MB).
+      std::size_t exchange_round_size = 1 << 26;
+
+      // Variable: incumbent_channel
+      // If true, and the state type provides bound() and bound(v), ranks share the best
+      // bound during superstep via an MPI one-sided window, so that they can prune
+      // with the global incumbent before the end of superstep (default: false).
+      bool incumbent_channel = false;
+
+      // Variable: incumbent_interval
+      // The number of tasks a rank processes between incumbent updates (default: 64).
+      int incumbent_interval = 64;
+
+      // Constants: termination_type
+      // TOKENS - a thief stops stealing once every other rank declined its request, or is known
+      //          to be passive via tokens piggybacked on messages, i.e., O(P) requests per rank.
+      // TREE   - ranks report exhausted local work up a binary tree, and the root announces the end
+      //          of stealing down the tree, i.e., O(log P) rounds after work is exhausted. A thief gives up
+      //          after <termination_attempts> consecutive failed steals, and tokens are not piggybacked.
+      enum termination_type { TOKENS, TREE };
+
+      // Variable: termination
+      // Termination detection used to end stealing phase of superstep (default: TOKENS).
+      termination_type termination = TOKENS;
+
+      // Variable: termination_attempts
+      // In TREE mode, the number of consecutive failed steals after which a thief
+      // waits for the end of stealing. 0 means 2 * log2(P) (default: 0).
+      int termination_attempts = 0;
+
+      // Variable: token_words
+      // In TOKENS mode, the number of non-zero 64-bit words of the passive ranks bitmap
+      // piggybacked on a message, together with their indices. Consecutive messages carry
+      // consecutive words, so the message head remains O(log P). The whole bitmap, packed
+      // into bytes, is sent if it is not larger. 0 means log2(P) (default: 0).
+      // With the sparse encoding tokens become hints: a rank may learn that a victim is passive
+      // only after a failed steal, and may count more active ranks when sizing steal batches.
+      // Termination is not affected, since every victim is still eventually ruled out.
+      int token_words = 0;
+
+      // Variable: adaptive_granularity
+      // If true, executors with unique tasks measure time per task and per steal, and use them
+      // to set steal batch size, the size of local (non-stealable) part of the queue, and the number
+      // of tasks claimed per lock. Otherwise, fixed values are used (default: true).
+      bool adaptive_granularity = true;
+
+      // Constants: stealing_type
+      // TWO_SIDED - victims answer steal requests in a listener thread, which requires MPI_THREAD_MULTIPLE.
+      // ONE_SIDED - thieves claim a range of victim's queue with MPI_Fetch_and_op, and pull it with MPI_Get.
+      //             Victims are not involved and there is no listener thread. Supported by <mpi_executor>
+      //             with unique tasks, which then ignores <protocol>, <steal_requests> and <termination>.
+      enum stealing_type { TWO_SIDED, ONE_SIDED };
+
+      // Variable: stealing
+      // Work stealing mechanism (default: TWO_SIDED).
+      stealing_type stealing = TWO_SIDED;
+
+      // Constants: progress_type
+      // THREAD  - steal and reduction requests are served by a listener thread,
+      //           which requires MPI_THREAD_MULTIPLE.
+      // POLLING - there is no listener thread, and pending requests are served by the main thread
+      //           every <poll_tasks> tasks or <poll_interval> microseconds, whichever comes first,
+      //           and while it waits for steal answers. Requires only MPI_THREAD_FUNNELED.
+      enum progress_type { THREAD, POLLING };
+
+      // Variable: progress
+      // How requests from other ranks are served (default: THREAD).
+      progress_type progress = THREAD;
+
+      // Variable: poll_tasks
+      // In POLLING mode, the number of tasks processed between polls (default: 64).
+      int poll_tasks = 64;
+
+      // Variable: poll_interval
+      // In POLLING mode, the maximum time in microseconds between polls (default: 100).
+      int poll_interval = 100;
+
+      // Variable: steal_fraction
+      // In executors with non-unique tasks, the fraction of victim's remaining tasks handed over
+      // in one steal. With <exchange_tasks>, all remaining tasks of the victim are in the partitions
+      // it owns, and the slice is taken from their tail. Otherwise, it is combined from the tail of up
+      // to three non-empty partitions, starting with the partition owned by the thief. No more than
+      // this fraction of any single partition is taken (default: 0.5).
+      float steal_fraction = 0.5;
+
+      // Variable: steal_max_tasks
+      // In executors with non-unique tasks, the maximum number of tasks in one steal answer.
+      // 0 means no limit (default: 0).
+      int steal_max_tasks = 0;
+
+      // Constants: mapping_type
+      // MODULO   - task *t* is owned by rank pt(t) % P.
+      // BALANCED - pt(t) is hashed to one of <virtual_partitions> * P virtual partitions. At the end of
+      //            each superstep, before tasks are exchanged, virtual partitions are reassigned to ranks
+      //            greedily (the heaviest first, to the least loaded rank), using the global number
+      //            of new tasks in each. Tasks with the same pt(t) always share the owner.
+      enum mapping_type { MODULO, BALANCED };
+
+      // Variable: mapping
+      // In <mpi_executor> with non-unique tasks, how partitions given by the partitioner
+      // are assigned to ranks (default: MODULO).
+      mapping_type mapping = MODULO;
+
+      // Variable: virtual_partitions
+      // In BALANCED mapping, the number of virtual partitions per rank (default: 16).
+      int virtual_partitions = 16;
+
+      // Constants: distribution_type
+      // ROUND_ROBIN - initial tasks are dealt to ranks in turns.
+      // PARTITIONER - initial task *t* is sent to rank pt(t) % P, where pt is the partitioner passed to init.
+      enum distribution_type { ROUND_ROBIN, PARTITIONER };
+
+      // Variable: init_distribution
+      // In executors with unique tasks, how init scatters the initial tasks given by rank 0
+      // across ranks (default: ROUND_ROBIN).
+      distribution_type init_distribution = ROUND_ROBIN;
+
+      // Constants: synchronization_type
+      // BSP     - supersteps are separated by barriers, and the global task count and state
+      //           are reduced once all ranks are done.
+      // RELAXED - a rank done with its queue and stealing posts non-blocking reductions (MPI_Iallreduce)
+      //           of the task count and state, and until they complete processes its own tasks
+      //           of the next superstep (depth first, with a private copy of state merged afterwards).
+      //           Valid only if process() does not depend on iteration(), e.g., in tree search.
+      //           Supported by <mpi_executor> with unique tasks.
+      enum synchronization_type { BSP, RELAXED };
+
+      // Variable: synchronization
+      // How ranks synchronize at the end of superstep (default: BSP).
+      synchronization_type synchronization = BSP;
+
+  }; // struct mpi_config
+
+} // namespace scool
+
+#endif // MPI_CONFIG_HPP
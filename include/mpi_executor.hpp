@@ -16,18 +16,34 @@
 #ifndef MPI_EXECUTOR_HPP
 #define MPI_EXECUTOR_HPP
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <future>
+#include <iterator>
+#include <limits>
 #include <mutex>
+#include <numeric>
 #include <random>
+#include <string>
 #include <thread>
+#include <type_traits>
 
 #include <mpi.h>
 
+#include "checkpoint.hpp"
 #include "impl.hpp"
+#include "mpi_config.hpp"
+#include "metrics.hpp"
 #include "mpi_impl.hpp"
 #include "partitioner.hpp"
+#include "perf_counters.hpp"
+#include "spill_store.hpp"
+#include "trace.hpp"
 #include "utility.hpp"
 
 #include "mpix/logger.hpp"
@@ -49,12 +65,19 @@ namespace scool {
       int iteration() const { return exec_.iteration(); }
 
       void push(const task_type& t) {
-          if constexpr (Unique) impl::add_to<Unique>(exec_.next_, t);
-          else {
-              // group by partitioner
-              // TODO: use a efficient mod mapper
-              auto rank = exec_.pt_(t) % static_cast<std::size_t>(exec_.size_);
-              impl::add_to<Unique>(exec_.next_[rank], t);
+          exec_.mx_.tasks_pushed++;
+
+          if constexpr (Unique) {
+              if (exec_.m_dive__(t)) return;
+              impl::add_to<Unique>(exec_.next_, t);
+              if (exec_.budget_ > 0) exec_.m_tick_spill__();
+          } else {
+              // group by owner
+              int k = exec_.m_owner__(t);
+              auto n = exec_.next_[k].size();
+
+              impl::add_to<Unique>(exec_.next_[k], t);
+              if ((exec_.budget_ > 0) && (exec_.next_[k].size() > n)) exec_.m_tick_spill__(k);
           }
       } // push
 
@@ -67,13 +90,24 @@ namespace scool {
   }; // mpi_context
 
 
+  // Concept: has_bound
+  // Satisfied if state type *T* exposes an arithmetic bound,
+  // see <mpi_config::incumbent_channel>.
+  template <typename T>
+  concept has_bound = requires(T& st, const T& cst) {
+      requires std::is_arithmetic_v<std::remove_cvref_t<decltype(cst.bound())>>;
+      st.bound(cst.bound());
+  };
+
+
   // Class: mpi_executor_base__
   // Base class to derive <mpi_executor>.
   // Do not use directly!
   template <typename TaskType, typename StateType, typename Partitioner>
   class mpi_executor_base__ {
   protected:
-      using req_data_type = scool::impl::bitmap::storage_type;
+      // message heads are byte-granular
+      using req_data_type = unsigned char;
 
   public:
       using task_type = TaskType;
@@ -86,18 +120,32 @@ namespace scool {
       // REQ_ANS  - answer to steal request
       // REQ_FIN  - notification to finalize execution
       // REQ_RDC  - request to participate in reduction
-      enum request_type : req_data_type { REQ_NONE = 0, REQ_FIN = 1, REQ_ASK = 2, REQ_ANS = 3, REQ_RDC = 4 };
+      // REQ_DRN  - notification that subtree of ranks has no more work to give (TREE termination)
+      // REQ_END  - notification to end stealing (TREE termination)
+      enum request_type : req_data_type { REQ_NONE = 0, REQ_FIN = 1, REQ_ASK = 2, REQ_ANS = 3, REQ_RDC = 4,
+                                          REQ_DRN = 5, REQ_END = 6 };
 
       // tags used for identifying background communication
       enum REQUEST_TAGS : int { REQ_TAG = 101, ANS_TAG = 102, RDC_TAG = 103 };
 
 
-      explicit mpi_executor_base__(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1)
-          : Comm_(Comm) {
+      explicit mpi_executor_base__(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1,
+                                   const mpi_config& cfg = mpi_config())
+          : cfg_(cfg), Comm_(Comm) {
           MPI_Comm_size(Comm_, &size_);
           MPI_Comm_rank(Comm_, &rank_);
 
           tokens_.resize(size_);
+          m_set_token_words__();
+          m_set_topology__();
+          m_open_bound__();
+
+          if (cfg_.termination_attempts <= 0) {
+              cfg_.termination_attempts = 2 * std::max(1, static_cast<int>(std::ceil(std::log2(size_))));
+          }
+
+          // pipelined stealing must be able to match answers from any victim
+          if (cfg_.steal_requests > 1) cfg_.protocol = mpi_config::SINGLE_MESSAGE;
 
           if (seed == -1) {
               std::random_device rd;
@@ -109,19 +157,29 @@ namespace scool {
           }
 
           log_.rank(rank_);
+          SCOOL_TRACE_RANK(rank_);
       } // mpi_executor_base__
 
       virtual ~mpi_executor_base__() {
+          m_report_heads__();
+
           // block and wait for everybody else to finish
           MPI_Barrier(Comm_);
 
-          // initiate terminating the helper thread
-          m_send_message_head__(REQ_FIN, rank_, Comm_hlp_);
+          // initiate terminating the helper thread, if there is one
+          if (hlp_th_.joinable()) {
+              m_send_message_head__(REQ_FIN, rank_, Comm_hlp_);
+              hlp_th_.join();
+          }
 
-          // now we can finish
-          hlp_th_.join();
+          if (bound_win_ != MPI_WIN_NULL) {
+              MPI_Win_unlock_all(bound_win_);
+              MPI_Win_free(&bound_win_);
+          }
 
           MPI_Comm_free(&this->Comm_hlp_);
+
+          SCOOL_TRACE_WRITE();
       } // ~mpi_executor_base__
 
 
@@ -134,12 +192,44 @@ namespace scool {
       // Function: state
       const state_type& state() { return gst_; }
 
+      // Function: checkpoint
+      // Enables checkpointing: every *interval* supersteps the current frontier,
+      // the global state and the iteration counter are written to file *name*.
+      // Ranks write their frontiers in parallel with MPI-IO, and the file is replaced
+      // only once all ranks have completely written their part.
+      void checkpoint(const std::string& name, int interval) {
+          ckpt_name_ = name;
+          ckpt_interval_ = interval;
+      } // checkpoint
+
+      // Function: on_metrics
+      // Sets function called with <metrics> of this rank at the end of each superstep.
+      void on_metrics(std::function<void(const metrics&)> f) { sink_.callback(std::move(f)); }
+
+      // Function: metrics_file
+      // Writes <metrics> of each superstep to file *name*, as JSON Lines with one line per rank.
+      // Records are gathered and written by rank 0. All ranks must call it.
+      //
+      // Returns:
+      //   false if *name* could not be opened.
+      bool metrics_file(const std::string& name) {
+          int res = 1;
+          if (rank_ == 0) res = sink_.open(name);
+
+          MPI_Bcast(&res, 1, MPI_INT, 0, Comm_);
+          mx_file_ = (res == 1);
+
+          return mx_file_;
+      } // metrics_file
+
 
   protected:
       // logger
       const std::string NAME_{"MPIExecutor"};
       mpix::Logger log_{-1};
 
+      mpi_config cfg_;
+
       // global attributes
       // total tasks, local tasks, remote tasks, variance
       long long int gcount_[4] = { 0, 0, 0, 0 };
@@ -148,14 +238,40 @@ namespace scool {
       state_type gst_;
       state_type lst_; // local state
       state_type rst_; // received state
+      state_type pst_; // global state at the beginning of superstep
+
+      // checkpoint file, and the number of supersteps between checkpoints
+      std::string ckpt_name_;
+      int ckpt_interval_ = 0;
 
       // tokens to piggyback current stealing state
       scool::impl::bitmap tokens_;
       std::mutex tokens_mtx_;
 
+      // the number of (index, word) token pairs per message head
+      // 0 means that the whole bitmap is sent
+      int token_words_ = 0;
+      int token_pos_ = 0;
+
+      // bytes per (index, word) pair
+      static const int TOKEN_PAIR = sizeof(std::uint32_t) + sizeof(scool::impl::bitmap::storage_type);
+
+      // message heads sent, and their total size in bytes
+      std::atomic<long long int> head_count_{0};
+      std::atomic<long long int> head_bytes_{0};
+
       std::atomic_flag passive_;
       std::mutex rdc_mtx_;
 
+      // raised when a steal request is declined in the current superstep,
+      // then executors stop depth-first processing
+      std::atomic_flag demand_;
+
+      // TREE termination, the number of drained ranks in subtree
+      // and flag raised when stealing should end
+      std::atomic_int drained_{0};
+      std::atomic_flag end_;
+
       // MPI env
       MPI_Comm Comm_;
 
@@ -165,13 +281,227 @@ namespace scool {
       MPI_Comm Comm_hlp_;
       std::thread hlp_th_;
 
+      // POLLING progress, tasks processed and time since the last poll
+      int poll_count_ = 0;
+      std::chrono::steady_clock::time_point poll_t0_;
+
+      // RELAXED synchronization, set by executors that support it
+      bool relaxed_ = false;
+
       // list of ranks to steal from
       // also keeps track of empty victims
       std::vector<int> vranks_;
 
+      // marks ranks that share node with this rank
+      std::vector<char> local_;
+
       std::mt19937 rng0_;
       std::mt19937 rng1_;
 
+      // online cost model (in seconds)
+      // moving averages of time per task and per steal round trip
+      double task_cost_ = 0.0;
+      double steal_cost_ = 0.0;
+
+      // measurements in the current superstep
+      double task_time_ = 0.0;
+      long long int task_count_ = 0;
+
+      double steal_time_ = 0.0;
+      long long int steal_count_ = 0;
+
+      // granularity of executors with unique tasks, see m_set_granularity__
+      // local (non-stealable) part of the queue
+      double local_queue_size_ = 0.20;
+
+      // workers lock task_chunk_ tasks at a time
+      // helper thread - allow stealing if tasks > task_chunk_
+      // and steals at least min_steal_batch_ tasks
+      int task_chunk_ = 10;
+      int min_steal_batch_ = 10;
+
+      // steal latency in tasks, from the cost model
+      double steal_ratio_ = 0.0;
+
+      // cost model targets
+      const double LOCK_TIME = 50e-6;
+      const double STEAL_GAIN = 2.0;
+      const int MAX_TASK_BATCH = 1 << 16;
+
+      static double m_elapsed__(std::chrono::steady_clock::time_point t0) {
+          return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      } // m_elapsed__
+
+      // metrics of the current superstep
+      metrics mx_;
+      impl::metrics_sink sink_;
+      bool mx_file_ = false;
+      std::chrono::steady_clock::time_point mx_t0_;
+
+      void m_begin_metrics__() {
+          mx_ = metrics{};
+          mx_t0_ = std::chrono::steady_clock::now();
+      } // m_begin_metrics__
+
+      // barrier, waiting in it counts as idle time
+      void m_barrier__() {
+          SCOOL_TRACE_SCOPE("barrier");
+          auto t0 = std::chrono::steady_clock::now();
+          MPI_Barrier(Comm_);
+          mx_.time_idle += m_elapsed__(t0);
+      } // m_barrier__
+
+      // sums n task counters over ranks
+      void m_reduce_counts__(const long long int* in, long long int* out, int n) {
+          SCOOL_TRACE_SCOPE("reduce");
+          SCOOL_PERF_SCOPE(mx_.hw_reduce);
+          auto t0 = std::chrono::steady_clock::now();
+          MPI_Allreduce(in, out, n, MPI_LONG_LONG_INT, MPI_SUM, Comm_);
+          mx_.time_reduce += m_elapsed__(t0);
+      } // m_reduce_counts__
+
+      // completes metrics of the superstep and passes them on,
+      // collective if metrics file is open
+      void m_end_metrics__() {
+          mx_.iteration = giter_ - 1;
+          mx_.rank = rank_;
+          mx_.time_total = m_elapsed__(mx_t0_);
+
+          sink_.call(mx_);
+          if (!mx_file_) return;
+
+          static_assert(std::is_trivially_copyable_v<metrics>);
+          std::vector<metrics> all((rank_ == 0) ? size_ : 0);
+
+          MPI_Gather(&mx_, sizeof(metrics), MPI_BYTE, all.data(), sizeof(metrics), MPI_BYTE, 0, Comm_);
+          for (auto& m : all) sink_.write(m);
+      } // m_end_metrics__
+
+      // folds measurements from the current superstep into the cost model
+      void m_update_costs__() {
+          const double ALPHA = 0.5;
+
+          if (task_count_ > 0) {
+              double c = task_time_ / task_count_;
+              task_cost_ = (task_cost_ == 0.0) ? c : (ALPHA * c + (1.0 - ALPHA) * task_cost_);
+          }
+
+          if (steal_count_ > 0) {
+              double c = steal_time_ / steal_count_;
+              steal_cost_ = (steal_cost_ == 0.0) ? c : (ALPHA * c + (1.0 - ALPHA) * steal_cost_);
+          }
+
+          task_time_ = 0.0;
+          task_count_ = 0;
+
+          steal_time_ = 0.0;
+          steal_count_ = 0;
+      } // m_update_costs__
+
+      // derives stealing granularity for the next superstep from the cost model,
+      // n is the size of the queue, nworkers the number of threads claiming from it,
+      // and mtx is the lock under which listener reads the granularity
+      void m_set_granularity__(std::mutex& mtx, std::size_t n, int nworkers = 1) {
+          m_update_costs__();
+
+          if (!cfg_.adaptive_granularity || (task_cost_ == 0.0)) return;
+
+          // a worker holds lock for about LOCK_TIME worth of its work
+          int task_chunk = std::clamp<double>(std::round(LOCK_TIME / (nworkers * task_cost_)), 1, MAX_TASK_BATCH);
+
+          // stealing pays off only if processing a batch outweighs its latency
+          double ratio = steal_cost_ / task_cost_;
+          int min_steal_batch = std::clamp<double>(std::ceil(STEAL_GAIN * ratio), task_chunk, MAX_TASK_BATCH);
+
+          // local part of the queue should keep rank busy
+          // while the first log2(P) steal rounds complete
+          double local_queue_size = local_queue_size_;
+
+          if ((steal_cost_ > 0.0) && (n > 0)) {
+              double reserve = (std::log2(size_) + 1) * ratio;
+              local_queue_size = std::clamp(reserve / n, 0.05, 0.5);
+          }
+
+          {
+              std::lock_guard<std::mutex> lock(mtx);
+              task_chunk_ = task_chunk;
+              min_steal_batch_ = min_steal_batch;
+              local_queue_size_ = local_queue_size;
+              steal_ratio_ = ratio;
+          }
+
+          log().debug(NAME_) << "task cost: " << (1e6 * task_cost_) << "us"
+                             << ", steal cost: " << (1e6 * steal_cost_) << "us"
+                             << ", lock chunk: " << task_chunk
+                             << ", min steal batch: " << min_steal_batch
+                             << ", local queue: " << local_queue_size
+                             << std::endl;
+      } // m_set_granularity__
+
+      // fraction of avail tasks handed over in one steal, active is the number of ranks with work
+      // the victim serves about avail / steal_ratio_ requests before its work runs out,
+      // and splits the work evenly between that many thieves, but not more than there are idle ranks
+      double m_steal_fraction__(int avail, int active) const {
+          // no measurements yet, more active ranks larger batches (1.0% -> 10.0%)
+          if (steal_ratio_ == 0.0) return std::max((active / static_cast<double>(size_)) * 0.1, 0.01);
+
+          double idle = std::max(size_ - active, 1);
+          double m = std::min(idle, avail / steal_ratio_);
+
+          return std::clamp(1.0 / (m + 1.0), 0.01, 0.5);
+      } // m_steal_fraction__
+
+      // incumbent channel, the global bound lives on rank 0
+      MPI_Win bound_win_ = MPI_WIN_NULL;
+      int bound_count_ = 0;
+
+      void m_open_bound__() {
+          if constexpr (has_bound<state_type>) {
+              if (!cfg_.incumbent_channel) return;
+
+              using value_type = std::remove_cvref_t<decltype(gst_.bound())>;
+              value_type* base = nullptr;
+
+              MPI_Aint sz = (rank_ == 0) ? sizeof(value_type) : 0;
+              MPI_Win_allocate(sz, sizeof(value_type), MPI_INFO_NULL, Comm_, &base, &bound_win_);
+
+              if (rank_ == 0) *base = std::numeric_limits<value_type>::max();
+
+              // passive target epoch for the entire lifetime
+              MPI_Win_lock_all(MPI_MODE_NOCHECK, bound_win_);
+              MPI_Barrier(Comm_);
+          }
+      } // m_open_bound__
+
+      // publishes bound of st and tightens it with the global incumbent
+      void m_sync_bound__(state_type& st) {
+          if constexpr (has_bound<state_type>) {
+              if (bound_win_ == MPI_WIN_NULL) return;
+
+              using value_type = std::remove_cvref_t<decltype(st.bound())>;
+              auto T = mpix::MPI_Type<value_type>();
+
+              value_type v = st.bound();
+              value_type g = v;
+
+              // fetches the old incumbent and applies min in one atomic operation
+              MPI_Fetch_and_op(&v, &g, T, 0, 0, MPI_MIN, bound_win_);
+              MPI_Win_flush(0, bound_win_);
+
+              if (g < v) st.bound(g);
+          }
+      } // m_sync_bound__
+
+      // called after every processed task
+      void m_tick_bound__(state_type& st) {
+          if constexpr (has_bound<state_type>) {
+              if ((bound_win_ != MPI_WIN_NULL) && (++bound_count_ >= cfg_.incumbent_interval)) {
+                  bound_count_ = 0;
+                  m_sync_bound__(st);
+              }
+          }
+      } // m_tick_bound__
+
       // this method reduces gst_ over the b-tree
       void m_reduce_and_forward__(MPI_Comm Comm) {
           rdc_mtx_.lock();
@@ -190,49 +520,309 @@ namespace scool {
           rdc_mtx_.unlock();
       } // m_reduce_and_forward__
 
+      // makes gst_ global at the end of superstep, if reduce is false gst_ on rank 0
+      // already holds the reduction (e.g., done by listeners), the payload is broadcast
+      // only if the global state changed in this superstep
+      void m_sync_state__(bool reduce) {
+          SCOOL_PERF_SCOPE(mx_.hw_reduce);
+
+          if (reduce) {
+              SCOOL_TRACE_SCOPE("reduce");
+              auto t0 = std::chrono::steady_clock::now();
+
+              if constexpr (archive::is_bitwise_v<state_type>) {
+                  mpi_impl::allreduce(gst_, Comm_);
+                  gst_.identity();
+                  pst_ = gst_;
+                  mx_.time_reduce += m_elapsed__(t0);
+                  return;
+              }
+
+              mpi_impl::reduce(gst_, Comm_);
+              mx_.time_reduce += m_elapsed__(t0);
+          }
+
+          gst_.identity();
+
+          SCOOL_TRACE_SCOPE("broadcast");
+          auto t0 = std::chrono::steady_clock::now();
+
+          mpi_impl::broadcast(gst_, pst_, Comm_);
+          mx_.time_broadcast += m_elapsed__(t0);
+
+          pst_ = gst_;
+      } // m_sync_state__
+
+      // writes checkpoint if it is due, fill(archive::writer&) serializes local frontier,
+      // which becomes a separate block of the file
+      template <typename Fun>
+      void m_tick_checkpoint__(Fun fill) {
+          if ((ckpt_interval_ < 1) || (giter_ % ckpt_interval_ != 0)) return;
+
+          SCOOL_TRACE_SCOPE("checkpoint");
+          auto t0 = std::chrono::steady_clock::now();
+
+          std::vector<char> block;
+          archive::writer bar(block);
+          fill(bar);
+
+          std::uint64_t sz = block.size();
+          std::vector<std::uint64_t> sizes(size_);
+
+          MPI_Allgather(&sz, 1, MPI_UINT64_T, sizes.data(), 1, MPI_UINT64_T, Comm_);
+
+          // global state is the same on all ranks
+          std::vector<char> head;
+          archive::writer har(head);
+          impl::write_checkpoint_head(har, giter_, gst_, sizes);
+
+          std::uint64_t off = head.size() + std::accumulate(std::begin(sizes), std::begin(sizes) + rank_, std::uint64_t(0));
+          std::uint64_t total = head.size() + std::accumulate(std::begin(sizes), std::end(sizes), std::uint64_t(0));
+          std::uint64_t max_sz = std::max<std::uint64_t>(head.size(), *std::max_element(std::begin(sizes), std::end(sizes)));
+
+          std::string tmp = ckpt_name_ + ".tmp";
+          MPI_File fh;
+
+          if (MPI_File_open(Comm_, tmp.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+              log().error(NAME_) << "could not open checkpoint " << tmp << std::endl;
+              return;
+          }
+
+          int res = (MPI_File_set_size(fh, total) == MPI_SUCCESS);
+
+          if (rank_ > 0) head.clear();
+          res = res && m_write_at__(fh, 0, head, max_sz);
+          res = res && m_write_at__(fh, off, block, max_sz);
+
+          MPI_File_close(&fh);
+          MPI_Allreduce(MPI_IN_PLACE, &res, 1, MPI_INT, MPI_LAND, Comm_);
+
+          if (rank_ == 0) {
+              if (res && (std::rename(tmp.c_str(), ckpt_name_.c_str()) == 0)) {
+                  log().info(NAME_) << "checkpoint " << ckpt_name_ << " written, " << total << " bytes in "
+                                    << m_elapsed__(t0) << "s" << std::endl;
+              } else log().error(NAME_) << "could not write checkpoint " << ckpt_name_ << std::endl;
+          }
+      } // m_tick_checkpoint__
+
+      // collective write of buf at offset off, all ranks must pass the same max_sz,
+      // which is the size of the largest buffer, so that they make the same number of calls
+      static bool m_write_at__(MPI_File fh, std::uint64_t off, const std::vector<char>& buf, std::uint64_t max_sz) {
+          const std::uint64_t CHUNK = 1 << 30;
+          bool res = true;
+
+          for (std::uint64_t pos = 0; pos < max_sz; pos += CHUNK) {
+              int n = (pos < buf.size()) ? std::min(CHUNK, buf.size() - pos) : 0;
+              const char* data = (n > 0) ? (buf.data() + pos) : buf.data();
+              res = res && (MPI_File_write_at_all(fh, off + pos, data, n, MPI_BYTE, MPI_STATUS_IGNORE) == MPI_SUCCESS);
+          }
+
+          return res;
+      } // m_write_at__
+
+      static bool m_read_at__(MPI_File fh, std::uint64_t off, std::vector<char>& buf) {
+          const std::uint64_t CHUNK = 1 << 30;
+
+          for (std::uint64_t pos = 0; pos < buf.size(); pos += CHUNK) {
+              int n = std::min(CHUNK, buf.size() - pos);
+              if (MPI_File_read_at(fh, off + pos, buf.data() + pos, n, MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS) return false;
+          }
+
+          return true;
+      } // m_read_at__
+
+      // reads checkpoint written by any executor, possibly with a different number of ranks,
+      // blocks are assigned to ranks round robin, add(task_type&&) stores a task,
+      // returns the number of local tasks, or -1 on all ranks if name is not a valid checkpoint
+      // or any rank fails to read it
+      template <typename Fun>
+      long long int m_read_checkpoint__(const std::string& name, Fun add) {
+          MPI_File fh;
+          if (MPI_File_open(Comm_, name.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) return -1;
+
+          MPI_Offset fsize = 0;
+          int res = (MPI_File_get_size(fh, &fsize) == MPI_SUCCESS);
+
+          impl::checkpoint_head h;
+          std::vector<char> buf(impl::checkpoint_head::PREFIX);
+
+          // every rank reads the same head
+          res = res && m_read_at__(fh, 0, buf);
+
+          if (res) {
+              archive::reader ar(buf);
+              res = impl::read_checkpoint_prefix(ar, h, fsize);
+          }
+
+          if (res) {
+              buf.resize(h.tail());
+              res = m_read_at__(fh, impl::checkpoint_head::PREFIX, buf);
+          }
+
+          if (res) {
+              archive::reader ar(buf);
+              res = impl::read_checkpoint_tail(ar, h, gst_, fsize);
+          }
+
+          long long int count = 0;
+
+          for (std::uint64_t b = rank_; res && (b < h.nblocks); b += size_) {
+              buf.resize(h.offs[b + 1] - h.offs[b]);
+              res = m_read_at__(fh, h.offs[b], buf);
+              if (res) count += impl::for_each_checkpoint_task<task_type>(buf.data(), buf.size(), add);
+          }
+
+          MPI_File_close(&fh);
+
+          // ranks must agree, since restart continues with collectives
+          MPI_Allreduce(MPI_IN_PLACE, &res, 1, MPI_INT, MPI_LAND, Comm_);
+          if (!res) return -1;
+
+          giter_ = h.iter;
+
+          log().info(NAME_) << "restarted from " << name << ", superstep " << giter_ << std::endl;
+
+          return count;
+      } // m_read_checkpoint__
+
 
       // these methods implement basic protocol for task stealing
       // every message contains request id and current status of tokens
-      std::pair<req_data_type, int> m_receive_message_head__(int Tag, MPI_Comm Comm) {
-          std::vector<req_data_type> msg(1 + tokens_.storage_size());
+      req_data_type m_process_message_head__(const req_data_type* msg, int target) {
+          if (msg[0] == REQ_FIN) return REQ_FIN;
 
-          // receiving a request
-          MPI_Status stat;
-          MPI_Recv(msg.data(), msg.size(), mpix::MPI_Type<req_data_type>(), MPI_ANY_SOURCE, Tag, Comm, &stat);
-          int target = stat.MPI_SOURCE;
+          if (msg[0] == REQ_RDC) return REQ_RDC;
 
-          if (msg[0] == REQ_FIN) return { REQ_FIN, target };
+          if (msg[0] == REQ_DRN) {
+              m_drained__();
+              return REQ_DRN;
+          }
 
-          if (msg[0] == REQ_RDC) return { REQ_RDC, target };
+          if (msg[0] == REQ_END) {
+              m_end__();
+              return REQ_END;
+          }
 
           if (tokens_mtx_.try_lock()) {
-              tokens_.OR(msg.data() + 1);
+              if (cfg_.termination == mpi_config::TOKENS) {
+                  if (token_words_ == 0) tokens_.OR_packed(msg + 1);
+                  else m_unpack_tokens__(msg + 1);
+              }
               if (msg[0] == REQ_NONE) tokens_.set(target);
               tokens_mtx_.unlock();
           }
 
-          return { msg[0], target };
+          return msg[0];
+      } // m_process_message_head__
+
+      // request id followed by tokens, if they are used
+      // tokens are either the byte-packed bitmap, or the number of pairs
+      // followed by token_words_ (index, word) pairs
+      int m_head_size__() const {
+          if (cfg_.termination != mpi_config::TOKENS) return 1;
+          if (token_words_ == 0) return 1 + tokens_.packed_size();
+          return 2 + TOKEN_PAIR * token_words_;
+      } // m_head_size__
+
+      // sparse encoding is used only when it is smaller than the byte-packed bitmap
+      void m_set_token_words__() {
+          if (cfg_.termination != mpi_config::TOKENS) return;
+
+          int k = cfg_.token_words;
+          if (k <= 0) k = std::max(1, static_cast<int>(std::ceil(std::log2(size_))));
+
+          // the number of pairs must fit in one byte
+          k = std::min(k, 255);
+
+          if (2 + TOKEN_PAIR * k < 1 + tokens_.packed_size()) token_words_ = k;
+      } // m_set_token_words__
+
+      // writes non-zero words starting from the rotating cursor,
+      // such that the entire bitmap is spread over consecutive messages
+      // a single head carries only a subset of tokens, so receivers treat them as hints
+      // the caller must hold tokens_mtx_
+      void m_pack_tokens__(req_data_type* msg) {
+          int sz = tokens_.storage_size();
+          int n = 0;
+
+          for (int i = 0; (i < sz) && (n < token_words_); ++i) {
+              int w = (token_pos_ + i) % sz;
+              auto x = tokens_.word(w);
+
+              if (x != 0) {
+                  std::uint32_t idx = w;
+                  std::memcpy(msg + 1 + TOKEN_PAIR * n, &idx, sizeof(idx));
+                  std::memcpy(msg + 1 + TOKEN_PAIR * n + sizeof(idx), &x, sizeof(x));
+                  token_pos_ = (w + 1) % sz;
+                  n++;
+              }
+          }
+
+          msg[0] = n;
+      } // m_pack_tokens__
+
+      // the caller must hold tokens_mtx_
+      void m_unpack_tokens__(const req_data_type* msg) {
+          int n = msg[0];
+
+          for (int i = 0; i < n; ++i) {
+              std::uint32_t idx;
+              scool::impl::bitmap::storage_type x;
+              std::memcpy(&idx, msg + 1 + TOKEN_PAIR * i, sizeof(idx));
+              std::memcpy(&x, msg + 1 + TOKEN_PAIR * i + sizeof(idx), sizeof(x));
+              tokens_.OR(idx, x);
+          }
+      } // m_unpack_tokens__
+
+      void m_report_heads__() {
+          long long int count[2] = { head_count_.load(), head_bytes_.load() };
+          MPI_Allreduce(MPI_IN_PLACE, count, 2, MPI_LONG_LONG_INT, MPI_SUM, Comm_);
+
+          if (count[0] > 0) {
+              log().debug(NAME_) << "message heads: " << count[0]
+                                 << ", average size: " << (static_cast<double>(count[1]) / count[0])
+                                 << "B, dense bitmap head: " << (1 + (size_ + 7) / 8) << "B" << std::endl;
+          }
+      } // m_report_heads__
+
+      std::pair<req_data_type, int> m_receive_message_head__(int Tag, MPI_Comm Comm) {
+          std::vector<req_data_type> msg(m_head_size__());
+
+          // receiving a request
+          MPI_Status stat;
+          MPI_Recv(msg.data(), msg.size(), mpix::MPI_Type<req_data_type>(), MPI_ANY_SOURCE, Tag, Comm, &stat);
+          int target = stat.MPI_SOURCE;
+
+          return { m_process_message_head__(msg.data(), target), target };
       } // m_receive_message_head__
 
       std::pair<req_data_type, int> m_receive_message_head__(MPI_Comm Comm) {
           return m_receive_message_head__(REQ_TAG, Comm);
       } // m_receive_message_head__
 
-      void m_send_message_head__(request_type req, int target, int Tag, MPI_Comm Comm) {
-          std::vector<req_data_type> msg(1 + tokens_.storage_size());
+      std::vector<req_data_type> m_make_message_head__(request_type req, bool with_tokens) {
+          std::vector<req_data_type> msg(m_head_size__());
 
           // request id
           msg[0] = req;
 
-          if (req == REQ_ASK) {
+          if (with_tokens && (cfg_.termination == mpi_config::TOKENS)) {
               // tokens
-              auto tp = tokens_.storage();
-
               tokens_mtx_.lock();
-              std::copy(tp, tp + tokens_.storage_size(), std::begin(msg) + 1);
+              if (token_words_ == 0) tokens_.pack(msg.data() + 1);
+              else m_pack_tokens__(msg.data() + 1);
               tokens_mtx_.unlock();
           }
 
+          head_count_++;
+          head_bytes_ += msg.size() * sizeof(req_data_type);
+
+          return msg;
+      } // m_make_message_head__
+
+      void m_send_message_head__(request_type req, int target, int Tag, MPI_Comm Comm) {
+          auto msg = m_make_message_head__(req, req == REQ_ASK);
+
           // here we go
           MPI_Send(msg.data(), msg.size(), mpix::MPI_Type<req_data_type>(), target, Tag, Comm);
       } // m_send_message_head__
@@ -242,31 +832,364 @@ namespace scool {
       } // m_send_message_head__
 
 
-      void m_set_vranks__() {
+      // answer to steal request with tasks [first, last)
+      template <typename Iter>
+      void m_send_answer__(Iter first, Iter last, int target, MPI_Comm Comm) {
+          if (cfg_.protocol == mpi_config::MULTI_MESSAGE) {
+              m_send_message_head__(REQ_ANS, target, ANS_TAG, Comm);
+              mpi_impl::serialize_and_send(first, last, target, ANS_TAG, Comm);
+              return;
+          }
+
+          // head, tokens and tasks go in one message
+          auto msg = m_make_message_head__(REQ_ANS, true);
+          int hsz = msg.size() * sizeof(req_data_type);
+
+          if constexpr (archive::is_bitwise_v<task_type> && std::contiguous_iterator<Iter>) {
+              std::size_t sz = (last - first) * sizeof(task_type);
+
+              if (hsz + sz <= mpi_impl::MAX_MESSAGE_SIZE) {
+                  mpi_impl::send_parts(msg.data(), hsz, std::to_address(first), sz, target, ANS_TAG, Comm);
+                  return;
+              }
+          } else {
+              std::vector<char> data;
+              archive::writer ar(data);
+
+              ar.write(msg.data(), hsz);
+              mpi_impl::pack_range(ar, first, last);
+
+              if (data.size() <= mpi_impl::MAX_MESSAGE_SIZE) {
+                  MPI_Send(data.data(), data.size(), MPI_BYTE, target, ANS_TAG, Comm);
+              } else {
+                  // too large for one message: head goes alone, and tasks follow as a range
+                  MPI_Send(data.data(), hsz, MPI_BYTE, target, ANS_TAG, Comm);
+                  mpi_impl::send_bytes(data.data() + hsz, data.size() - hsz, target, ANS_TAG, Comm);
+              }
+
+              return;
+          }
+
+          // too large for one message: head goes alone, and tasks follow as a range
+          MPI_Send(msg.data(), hsz, MPI_BYTE, target, ANS_TAG, Comm);
+          mpi_impl::serialize_and_send(first, last, target, ANS_TAG, Comm);
+      } // m_send_answer__
+
+      // receive answer to steal request sent to target
+      // stolen tasks are appended to T
+      req_data_type m_receive_answer__(int target, std::vector<task_type>& T, MPI_Comm Comm) {
+          if (cfg_.protocol == mpi_config::MULTI_MESSAGE) {
+              auto [req, _] = m_receive_message_head__(ANS_TAG, Comm);
+              if (req == REQ_ANS) mx_.steal_bytes += mpi_impl::receive_range(T, target, ANS_TAG, Comm);
+              return req;
+          }
+
+          std::vector<req_data_type> msg(m_head_size__());
+          int hsz = msg.size() * sizeof(req_data_type);
+
+          int sz = mpi_impl::probe_size(target, ANS_TAG, Comm) - hsz;
+
+          // head without tasks means that tasks follow as a range
+          if (sz == 0) {
+              MPI_Status stat;
+              MPI_Recv(msg.data(), hsz, MPI_BYTE, target, ANS_TAG, Comm, &stat);
+
+              auto req = m_process_message_head__(msg.data(), target);
+              if (req == REQ_ANS) mx_.steal_bytes += mpi_impl::receive_range(T, target, ANS_TAG, Comm);
+
+              return req;
+          }
+
+          mx_.steal_bytes += sz;
+
+          if constexpr (archive::is_bitwise_v<task_type>) {
+              auto pos = T.size();
+              T.resize(pos + sz / sizeof(task_type));
+              mpi_impl::receive_parts(msg.data(), hsz, T.data() + pos, sz, target, ANS_TAG, Comm);
+          } else {
+              std::vector<char> data(hsz + sz);
+
+              MPI_Status stat;
+              MPI_Recv(data.data(), data.size(), MPI_BYTE, target, ANS_TAG, Comm, &stat);
+
+              archive::reader ar(data);
+              ar.read(msg.data(), hsz);
+              mpi_impl::unpack_range(ar, T);
+          }
+
+          return m_process_message_head__(msg.data(), target);
+      } // m_receive_answer__
+
+
+      // serves single request received by listener, or while polling
+      virtual void m_serve_request__(req_data_type req, int target, MPI_Comm Comm) = 0;
+
+      // this runs in listener thread
+      void m_request_listener__(MPI_Comm Comm) {
+          SCOOL_TRACE_THREAD("listener");
+
+          do {
+              auto [req, target] = m_receive_message_head__(Comm);
+              if (req == REQ_FIN) break;
+
+              SCOOL_TRACE_SCOPE("serve");
+              m_serve_request__(req, target, Comm);
+          } while (true);
+      } // m_request_listener__
+
+      // in POLLING mode there is no listener, and requests are served by the main thread
+      void m_start_listener__() {
+          if (cfg_.progress == mpi_config::THREAD) {
+              hlp_th_ = std::thread(&mpi_executor_base__::m_request_listener__, this, Comm_hlp_);
+          }
+      } // m_start_listener__
+
+      // rank 0 scatters [first, last) across ranks as given by cfg_.init_distribution,
+      // the received tasks are appended to Q, returns the total number of tasks
+      template <typename Iter>
+      long long int m_scatter_tasks__(Iter first, Iter last, const Partitioner& pt, std::vector<TaskType>& Q) {
+          long long int n = 0;
+
+          std::vector<char> buf;
+          std::vector<int> sizes(size_, 0);
+          std::vector<int> displs(size_, 0);
+
+          if (rank_ == 0) {
+              std::vector<std::vector<TaskType>> parts(size_);
+
+              for (; first != last; ++first, ++n) {
+                  std::size_t r = n;
+                  if (cfg_.init_distribution == mpi_config::PARTITIONER) r = pt(*first);
+                  parts[r % size_].push_back(*first);
+              }
+
+              archive::writer ar(buf);
+
+              for (int i = 1; i < size_; ++i) {
+                  displs[i] = ar.size();
+                  if (!parts[i].empty()) mpi_impl::pack_range(ar, std::begin(parts[i]), std::end(parts[i]));
+                  sizes[i] = ar.size() - displs[i];
+              }
+
+              std::move(std::begin(parts[0]), std::end(parts[0]), std::back_inserter(Q));
+          }
+
+          int sz = 0;
+          MPI_Scatter(sizes.data(), 1, MPI_INT, &sz, 1, MPI_INT, 0, Comm_);
+
+          std::vector<char> data(sz);
+          MPI_Scatterv(buf.data(), sizes.data(), displs.data(), MPI_BYTE, data.data(), sz, MPI_BYTE, 0, Comm_);
+
+          if (sz > 0) {
+              archive::reader ar(data);
+              mpi_impl::unpack_range(ar, Q);
+          }
+
+          MPI_Bcast(&n, 1, MPI_LONG_LONG_INT, 0, Comm_);
+
+          return n;
+      } // m_scatter_tasks__
+
+      // serves all pending requests
+      void m_poll__() {
+          int flag = 0;
+          MPI_Status stat;
+
+          do {
+              MPI_Iprobe(MPI_ANY_SOURCE, REQ_TAG, Comm_hlp_, &flag, &stat);
+              if (flag) {
+                  SCOOL_TRACE_SCOPE("serve");
+                  auto [req, target] = m_receive_message_head__(Comm_hlp_);
+                  m_serve_request__(req, target, Comm_hlp_);
+              }
+          } while (flag);
+
+          poll_count_ = 0;
+          poll_t0_ = std::chrono::steady_clock::now();
+      } // m_poll__
+
+      // called after every processed task, polls every cfg_.poll_tasks tasks or cfg_.poll_interval us
+      void m_tick_progress__() {
+          if (cfg_.progress != mpi_config::POLLING) return;
+          if ((++poll_count_ < cfg_.poll_tasks) && (1e6 * m_elapsed__(poll_t0_) < cfg_.poll_interval)) return;
+          m_poll__();
+      } // m_tick_progress__
+
+      // waits for answer to steal request, in POLLING mode serving requests in the meantime
+      MPI_Status m_wait_answer__(int source, MPI_Comm Comm) {
+          MPI_Status stat;
+
+          if (cfg_.progress == mpi_config::THREAD) MPI_Probe(source, ANS_TAG, Comm, &stat);
+          else {
+              int flag = 0;
+
+              while (true) {
+                  MPI_Iprobe(source, ANS_TAG, Comm, &flag, &stat);
+                  if (flag) break;
+                  m_poll__();
+              }
+          }
+
+          return stat;
+      } // m_wait_answer__
+
+      // in POLLING mode, the rank keeps serving requests until all ranks are done stealing
+      void m_quiesce__() {
+          MPI_Request req;
+          MPI_Ibarrier(Comm_hlp_, &req);
+
+          int flag = 0;
+
+          while (true) {
+              m_poll__();
+              MPI_Test(&req, &flag, MPI_STATUS_IGNORE);
+              if (flag) break;
+          }
+      } // m_quiesce__
+
+
+      // TREE termination: called when this rank, or one of its children, runs out of work
+      // the last one reports to the parent, at the root it ends stealing
+      void m_drained__() {
+          int nchild = static_cast<int>(2 * rank_ + 1 < size_) + static_cast<int>(2 * rank_ + 2 < size_);
+
+          if (drained_.fetch_add(1) + 1 == nchild + 1) {
+              if (rank_ > 0) m_send_message_head__(REQ_DRN, (rank_ - 1) >> 1, Comm_hlp_);
+              else m_end__();
+          }
+      } // m_drained__
+
+      // forwards REQ_END down the tree and releases thief
+      void m_end__() {
+          for (int i = 2 * rank_ + 1; (i < size_) && (i <= 2 * rank_ + 2); ++i) {
+              m_send_message_head__(REQ_END, i, Comm_hlp_);
+          }
+
+          end_.test_and_set();
+          end_.notify_all();
+      } // m_end__
+
+      // checks if thief should stop stealing
+      bool m_stop_stealing__(int fails) {
+          if (cfg_.termination != mpi_config::TREE) return false;
+          return end_.test() || (fails >= cfg_.termination_attempts);
+      } // m_stop_stealing__
+
+      // waits for the end of stealing and gets ready for the next superstep
+      void m_wait_end__() {
+          if (cfg_.termination != mpi_config::TREE) return;
+
+          if (cfg_.progress == mpi_config::THREAD) end_.wait(false);
+          else while (!end_.test()) m_poll__();
+
+          drained_.store(0);
+          end_.clear();
+      } // m_wait_end__
+
+      void m_set_topology__() {
+          local_.resize(size_, 0);
+
+          if (cfg_.steal_topology != mpi_config::NODE_FIRST) return;
+
+          MPI_Comm Comm_node;
+          MPI_Comm_split_type(Comm_, MPI_COMM_TYPE_SHARED, rank_, MPI_INFO_NULL, &Comm_node);
+
+          int nsize = 0;
+          MPI_Comm_size(Comm_node, &nsize);
+
+          MPI_Group node_group, group;
+          MPI_Comm_group(Comm_node, &node_group);
+          MPI_Comm_group(Comm_, &group);
+
+          std::vector<int> nranks(nsize);
+          std::vector<int> ranks(nsize);
+
+          std::iota(std::begin(nranks), std::end(nranks), 0);
+          MPI_Group_translate_ranks(node_group, nsize, nranks.data(), group, ranks.data());
+
+          for (auto r : ranks) local_[r] = 1;
+
+          MPI_Group_free(&node_group);
+          MPI_Group_free(&group);
+          MPI_Comm_free(&Comm_node);
+      } // m_set_topology__
+
+      // same-node victims go first
+      // returns the number of same-node victims
+      int m_set_vranks__() {
           vranks_.resize(size_ - 1);
           int pos = 0;
-          for (int i = 0; i < size_; ++i) if (i != rank_) vranks_[pos++] = i;
+
+          for (int i = 0; i < size_; ++i) if ((i != rank_) && local_[i]) vranks_[pos++] = i;
+          int lend = pos;
+
+          for (int i = 0; i < size_; ++i) if ((i != rank_) && !local_[i]) vranks_[pos++] = i;
+
+          return lend;
       } // m_set_vranks__
 
+      // randomly selects victim from vranks_[0, end)
+      // same-node victims in vranks_[0, lend) are preferred
+      int m_pick_victim__(int lend, int end) {
+          bool remote = (lend == 0);
+
+          if ((lend > 0) && (lend < end)) {
+              std::uniform_real_distribution<float> rdist(0.0, 1.0);
+              remote = (rdist(rng0_) < cfg_.remote_steal_probability);
+          }
+
+          // it seems we need this to avoid bias in load
+          std::uniform_int_distribution<int> udist(remote ? lend : 0, remote ? end - 1 : lend - 1);
+
+          return udist(rng0_);
+      } // m_pick_victim__
+
+      // moves vranks_[pos] out of [0, end) to vranks_[end - 1], and shrinks range
+      void m_remove_victim__(int pos, int& lend, int& end) {
+          if (pos < lend) {
+              std::swap(vranks_[pos], vranks_[lend - 1]);
+              pos = --lend;
+          }
+
+          std::swap(vranks_[pos], vranks_[end - 1]);
+          end--;
+      } // m_remove_victim__
+
+      // moves vranks_[pos], where pos >= end, back into [0, end)
+      void m_restore_victim__(int pos, int& lend, int& end) {
+          std::swap(vranks_[pos], vranks_[end]);
+
+          if (local_[vranks_[end]]) {
+              std::swap(vranks_[end], vranks_[lend]);
+              lend++;
+          }
+
+          end++;
+      } // m_restore_victim__
+
 
-      template <typename Context>
-      int m_steal_tasks__(MPI_Comm Comm, Context& ctx) {
-          m_set_vranks__();
+      // stealing loop, process is called on every batch of stolen tasks
+      template <typename Process>
+      int m_steal_tasks__(MPI_Comm Comm, Process process) {
+          SCOOL_TRACE_SCOPE("steal");
+
+          // local work is exhausted
+          if (cfg_.termination == mpi_config::TREE) m_drained__();
+
+          if (cfg_.steal_requests > 1) return m_steal_tasks_pipelined__(Comm, process);
 
           int count = 0;
+          int fails = 0;
 
           std::vector<task_type> T;
           T.reserve(1024);
 
-          auto out = std::back_inserter(T);
+          int lend = m_set_vranks__();
           int end = size_ - 1;
 
-          // it seems we need this to avoid bias in load
-          std::uniform_int_distribution<int> udist(0, end - 1);
-
-          while (end > 0) {
+          while ((end > 0) && !m_stop_stealing__(fails)) {
               // randomly selects a victim
-              int pos = udist(rng0_);
+              int pos = m_pick_victim__(lend, end);
               int target = vranks_[pos];
 
               // abort steal if victim is passive
@@ -275,40 +1198,174 @@ namespace scool {
               tokens_mtx_.unlock();
 
               if (vt == true) {
-                  end = end - 1;
-                  udist = std::uniform_int_distribution<int>(0, end - 1);
-                  std::swap(vranks_[pos], vranks_[end]);
+                  m_remove_victim__(pos, lend, end);
                   continue;
               }
 
+              auto t0 = std::chrono::steady_clock::now();
+
               // send request
               m_send_message_head__(REQ_ASK, target, Comm);
-              auto [req, _] = m_receive_message_head__(ANS_TAG, Comm);
+
+              if (cfg_.progress == mpi_config::POLLING) m_wait_answer__(target, Comm);
+
+              // receive the tasks directly into T
+              auto req = m_receive_answer__(target, T, Comm);
+
+              steal_time_ += m_elapsed__(t0);
+              steal_count_++;
+              mx_.steal_attempts++;
 
               if (req == REQ_ANS) {
-                  // receive and deserialize the tasks
-                  mpi_impl::receive_and_deserialize<task_type>(out, target, ANS_TAG, Comm);
+                  mx_.steal_successes++;
+                  mx_.tasks_stolen += T.size();
 
-                  for (auto& x : T) {
-                      x.process(ctx, gst_);
-                      count++;
-                  }
+                  t0 = std::chrono::steady_clock::now();
+
+                  process(T);
+                  count += T.size();
+
+                  task_time_ += m_elapsed__(t0);
+                  task_count_ += T.size();
 
                   T.clear();
+                  fails = 0;
               } else {
                   // remove target from consideration
-                  end = end - 1;
-                  udist = std::uniform_int_distribution<int>(0, end - 1);
-                  std::swap(vranks_[pos], vranks_[end]);
+                  m_remove_victim__(pos, lend, end);
+                  fails++;
               }
           } // while end
 
+          m_wait_end__();
+
           passive_.test_and_set();
-          m_reduce_and_forward__(Comm);
+
+          // without listener, executors reduce state collectively
+          // in RELAXED mode, state is reduced collectively at the end of superstep,
+          // and requests are served until then
+          if (!relaxed_) {
+              if (cfg_.progress == mpi_config::THREAD) m_reduce_and_forward__(Comm);
+              else m_quiesce__();
+          }
 
           return count;
       } // m_steal_tasks__
 
+      // keeps up to cfg_.steal_requests requests in flight
+      // and processes batches in the order in which they arrive
+      template <typename Process>
+      int m_steal_tasks_pipelined__(MPI_Comm Comm, Process process) {
+          SCOOL_TRACE_SCOPE("steal");
+
+          int count = 0;
+          int fails = 0;
+
+          std::vector<task_type> T;
+          T.reserve(1024);
+
+          // vranks_ is split into [available | in flight | done]
+          // and available victims on the same node go first
+          int lavail = m_set_vranks__();
+          int avail = size_ - 1;
+          int inflight = 0;
+
+          // request heads must persist until sends complete
+          std::vector<std::vector<req_data_type>> heads;
+          std::vector<MPI_Request> sreq;
+
+          // when request to each rank was posted
+          std::vector<std::chrono::steady_clock::time_point> posted(size_);
+
+          auto post_requests = [&]() {
+              while ((inflight < cfg_.steal_requests) && (avail > 0) && !m_stop_stealing__(fails)) {
+                  int pos = m_pick_victim__(lavail, avail);
+                  int target = vranks_[pos];
+
+                  // target leaves available region
+                  m_remove_victim__(pos, lavail, avail);
+
+                  tokens_mtx_.lock();
+                  auto vt = tokens_[target];
+                  tokens_mtx_.unlock();
+
+                  if (vt == true) {
+                      // victim is passive, move it to done region
+                      std::swap(vranks_[avail], vranks_[avail + inflight]);
+                      continue;
+                  }
+
+                  inflight++;
+                  posted[target] = std::chrono::steady_clock::now();
+
+                  heads.push_back(m_make_message_head__(REQ_ASK, true));
+                  sreq.emplace_back();
+
+                  auto& msg = heads.back();
+                  MPI_Isend(msg.data(), msg.size(), mpix::MPI_Type<req_data_type>(), target, REQ_TAG, Comm, &sreq.back());
+              } // while
+          }; // post_requests
+
+          while (true) {
+              post_requests();
+              if (inflight == 0) break;
+
+              // whoever answers first
+              MPI_Status stat = m_wait_answer__(MPI_ANY_SOURCE, Comm);
+
+              int target = stat.MPI_SOURCE;
+              auto req = m_receive_answer__(target, T, Comm);
+
+              steal_time_ += m_elapsed__(posted[target]);
+              steal_count_++;
+              mx_.steal_attempts++;
+
+              int pos = avail;
+              while (vranks_[pos] != target) ++pos;
+
+              if (req == REQ_ANS) {
+                  // victim goes back to available region
+                  m_restore_victim__(pos, lavail, avail);
+                  inflight--;
+
+                  mx_.steal_successes++;
+                  mx_.tasks_stolen += T.size();
+
+                  // prefetch next batch before processing the current one
+                  post_requests();
+
+                  auto t0 = std::chrono::steady_clock::now();
+
+                  process(T);
+                  count += T.size();
+
+                  task_time_ += m_elapsed__(t0);
+                  task_count_ += T.size();
+
+                  T.clear();
+                  fails = 0;
+              } else {
+                  // victim goes to done region
+                  std::swap(vranks_[pos], vranks_[avail + inflight - 1]);
+                  inflight--;
+                  fails++;
+              }
+          } // while
+
+          MPI_Waitall(sreq.size(), sreq.data(), MPI_STATUSES_IGNORE);
+
+          m_wait_end__();
+
+          passive_.test_and_set();
+
+          if (!relaxed_) {
+              if (cfg_.progress == mpi_config::THREAD) m_reduce_and_forward__(Comm);
+              else m_quiesce__();
+          }
+
+          return count;
+      } // m_steal_tasks_pipelined__
+
 
   private:
       mpi_executor_base__(const mpi_executor_base__&) = delete;
@@ -352,12 +1409,15 @@ namespace scool {
       //          several different places. The seed should be configured to value
       //          different than -1 only in cases where deterministic behavior
       //          between different executions is desired.
-      explicit mpi_executor(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1)
-          : mpi_executor_base__<TaskType, StateType, Partitioner>(Comm, seed), ctx_(*this),
-            curr_(this->size_), next_(this->size_), curr_mtx_(this->size_), porder_(this->size_) {
+      //   cfg  - runtime configuration, see <mpi_config>.
+      explicit mpi_executor(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1, const mpi_config& cfg = mpi_config())
+          : mpi_executor_base__<TaskType, StateType, Partitioner>(Comm, seed, cfg), ctx_(*this),
+            curr_mtx_(this->size_), curr_(this->size_), curr_head_(this->size_, 0), next_(this->size_),
+            merged_(this->size_), porder_(this->size_),
+            pmap_(this->size_, this->size_ * std::max(1, cfg.virtual_partitions)) {
           // we have separate communicator for requests processing
           MPI_Comm_dup(this->Comm_, &this->Comm_hlp_);
-          this->hlp_th_ = std::thread(&mpi_executor::m_request_listener__, this, this->Comm_hlp_);
+          this->m_start_listener__();
 
           MPI_Barrier(this->Comm_);
 
@@ -366,9 +1426,8 @@ namespace scool {
 
 
       void init(const task_type& t, const state_type& st, const partitioner& pt = partitioner()) {
-          pt_ = pt;
           std::vector<task_type> v{t};
-          init(std::begin(v), std::end(v), st);
+          init(std::begin(v), std::end(v), st, pt);
       } // init
 
       // Function: init
@@ -377,19 +1436,58 @@ namespace scool {
           pt_ = pt;
 
           for (; first != last; ++first) {
-              auto rank = pt_(*first) % static_cast<std::size_t>(this->size_);
-              if (rank == this->rank_) impl::add_to<Unique>(curr_[rank], *first);
+              if (m_owner__(*first) == this->rank_) impl::add_to<Unique>(next_[this->rank_], *first);
           }
 
-          curr_size_ = curr_[this->rank_].size();
+          long long int count = m_swap_queues__();
           this->gst_ = st;
+          this->pst_ = st;
 
-          long long int count = curr_[this->rank_].size();
           MPI_Allreduce(&count, &this->gcount_[0], 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
 
           MPI_Barrier(this->Comm_);
       } // init
 
+      // Function: restart
+      // Initializes executor from checkpoint *name* written by any executor,
+      // possibly with a different number of ranks. Use instead of <init>.
+      //
+      // Returns:
+      //   false if *name* is not a valid checkpoint.
+      bool restart(const std::string& name, const partitioner& pt = partitioner()) {
+          pt_ = pt;
+
+          long long int count = this->m_read_checkpoint__(name, [this](task_type&& t) {
+              impl::add_to<Unique>(next_[m_owner__(t)], t);
+          });
+
+          if (count < 0) return false;
+
+          // blocks do not have to match owners
+          if (this->size_ > 1) m_exchange_queues__();
+
+          count = m_swap_queues__();
+          this->pst_ = this->gst_;
+
+          MPI_Allreduce(&count, &this->gcount_[0], 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+
+          MPI_Barrier(this->Comm_);
+
+          return true;
+      } // restart
+
+      // Function: memory_budget
+      // Limits memory used by new tasks that this rank keeps in a superstep to about *bytes*.
+      // Once the limit is exceeded, the tasks are spilled to scratch files in *dir*,
+      // partitioned by task hash. Before the next superstep, duplicates are merged
+      // one partition at a time. Tasks routed to other ranks stay in memory until exchange,
+      // and virtual partitions are not rebalanced while spilled tasks exist.
+      // 0 means no limit (default).
+      void memory_budget(std::size_t bytes, const std::string& dir = "/tmp") {
+          budget_ = bytes;
+          spill_next_.open(dir);
+      } // memory_budget
+
 
       // Function: step
       long long int step() {
@@ -397,19 +1495,51 @@ namespace scool {
                                         << " tasks, superstep " << this->giter_
                                         << "..." << std::endl;
 
+          this->m_begin_metrics__();
+
           long long int global_tasks  = this->gcount_[0];
           long long int count[4] = {0, 0, 0, 0};
           long long int local_task;
 
           // process local queue
+          auto t0 = std::chrono::steady_clock::now();
           count[1] = m_process_local_queue__();
+          this->mx_.time_process = this->m_elapsed__(t0);
 
           // go into stealing mode
-          count[2] = this->m_steal_tasks__(this->Comm_hlp_, ctx_);
+          t0 = std::chrono::steady_clock::now();
+
+          {
+              SCOOL_PERF_SCOPE(this->mx_.hw_steal);
+
+              count[2] = this->m_steal_tasks__(this->Comm_hlp_, [this](std::vector<task_type>& T) {
+                  for (auto& x : T) {
+                      x.process(ctx_, this->gst_);
+                      this->m_tick_bound__(this->gst_);
+                      this->m_tick_progress__();
+                  }
+              });
+          }
+
+          this->mx_.time_steal = this->m_elapsed__(t0);
+
+          // route new tasks to owners
+          long long int received = 0;
+
+          if (this->cfg_.exchange_tasks) {
+              t0 = std::chrono::steady_clock::now();
+              if (this->cfg_.mapping == mpi_config::BALANCED) m_rebalance__();
+              received = m_exchange_queues__();
+              this->mx_.time_exchange = this->m_elapsed__(t0);
+          }
+
+          // spilled duplicates must be merged before tasks are counted
+          if (!spill_next_.empty()) m_merge_spilled__();
 
           // update size
           count[0] = 0;
           for (auto& x : next_) count[0] += x.size();
+          for (auto& x : merged_) count[0] += x.size();
 
           // calculate standard deviation
           local_task = count[1] + count[2];
@@ -417,190 +1547,391 @@ namespace scool {
           double mean = (double) global_tasks / this->size_;
           double local_sq_diff = (local_task - mean) * (local_task - mean);
 
-          count[3] = std::llround(local_sq_diff);
+          count[3] = std::llround(local_sq_diff);
+
+          // take care of global state
+          this->m_reduce_counts__(count, this->gcount_, 4);
+
+          float sd = std::sqrt(this->gcount_[3] / this->size_);
+          float p_sd = (sd / mean) * 100;
+
+          this->log().debug(this->NAME_) << "local tasks: " << this->gcount_[1]
+                                         << ", remote tasks: " << this->gcount_[2]
+                                         << ", standard deviation: "<< p_sd <<"%"
+                                         << std::endl;
+
+          long long int processed_task =  this->gcount_[1] + this->gcount_[2];
+          if (processed_task != global_tasks) {
+              this->log().error() << "something went very wrong, task numbers mismatch!" << std::endl;
+          }
+
+          // get local queues in proper shape
+          // at this stage all ranks are in sync
+          this->tokens_.reset();
+          m_swap_queues__();
+
+          this->m_sync_state__(true);
+
+          this->giter_++;
+
+          this->m_tick_checkpoint__([this](archive::writer& ar) {
+              for (auto& Q : curr_) impl::save_frames(ar, std::begin(Q), std::end(Q));
+          });
+
+          auto& mx = this->mx_;
+
+          mx.tasks_processed = local_task;
+          mx.frontier_tasks = count[0];
+          mx.frontier_bytes = count[0] * sizeof(task_type);
+          mx.tasks_merged = mx.tasks_pushed - mx.tasks_exchanged + received - count[0];
+
+          this->m_end_metrics__();
+
+          return this->gcount_[0];
+      } // step
+
+
+  private:
+      // new tasks are merged in hash sets,
+      // and moved to vectors to process, so that any slice can be stolen cheaply
+      using local_storage_type = std::vector<phmap::node_hash_set<task_type>>;
+      using queue_type = std::vector<std::vector<task_type>>;
+
+      friend mpi_context<mpi_executor, Unique>;
+      mpi_context<mpi_executor, Unique> ctx_;
+
+      using typename mpi_executor_base__<TaskType, StateType, Partitioner>::req_data_type;
+
+      // this runs in listener thread, or in main thread when polling
+      void m_serve_request__(req_data_type req, int target, MPI_Comm Comm) override {
+          const int NUM_TRY = 3;
+
+          if (req != this->REQ_ASK) return;
+
+          std::vector<task_type> T;
+          int sz = curr_size_.load();
+
+          if (sz > 0) {
+              // we give away a fraction of what is left
+              int want = std::ceil(this->cfg_.steal_fraction * sz);
+              if (this->cfg_.steal_max_tasks > 0) want = std::min(want, this->cfg_.steal_max_tasks);
+
+              // once tasks are routed to owners, all work sits in the partition of this rank,
+              // so the slice comes from its tail
+              if (this->cfg_.exchange_tasks) {
+                  std::lock_guard<std::mutex> lock(curr_mtx_[this->rank_]);
+                  m_extract_tail__(this->rank_, want, T);
+              }
+
+              // otherwise let's try several non-empty partitions, and combine slices from them
+              // first is always work local to target (thief)
+              if (T.empty()) {
+                  int off = this->rng1_() % this->size_;
+                  int tries = 0;
+
+                  for (int i = -1; (i < this->size_) && (tries < NUM_TRY) && (static_cast<int>(T.size()) < want); ++i) {
+                      int pos = (i < 0) ? target : (off + i) % this->size_;
+                      if ((i >= 0) && (pos == target)) continue;
+
+                      if (curr_mtx_[pos].try_lock()) {
+                          if (curr_head_[pos] < static_cast<int>(curr_[pos].size())) {
+                              m_extract_tail__(pos, want - static_cast<int>(T.size()), T);
+                              tries++;
+                          }
+                          curr_mtx_[pos].unlock();
+                      } else tries++;
+                  } // for i
+              }
+          } // if sz
+
+          // tasks are already out of the queue, so we serialize without locks
+          if (T.empty()) this->m_send_message_head__(this->REQ_NONE, target, this->ANS_TAG, Comm);
+          else this->m_send_answer__(T.begin(), T.end(), target, Comm);
+      } // m_serve_request__
+
+      // moves up to n tasks from the tail of partition pos to T
+      // the caller must hold curr_mtx_[pos]
+      void m_extract_tail__(int pos, int n, std::vector<task_type>& T) {
+          auto& Q = curr_[pos];
+
+          int avail = Q.size() - curr_head_[pos];
+          if (avail <= 0) return;
+
+          // no more than a fraction of the partition
+          n = std::min<int>({n, avail, static_cast<int>(std::ceil(this->cfg_.steal_fraction * avail))});
+
+          auto first = std::end(Q) - n;
+          std::move(first, std::end(Q), std::back_inserter(T));
+
+          // this never reallocates, so slices claimed by the owner remain valid
+          Q.erase(first, std::end(Q));
+          curr_size_.fetch_sub(n);
+      } // m_extract_tail__
+
+      int m_process_local_queue__() {
+          SCOOL_TRACE_SCOPE("process_local_queue");
+          SCOOL_PERF_SCOPE(this->mx_.hw_process);
+
+          int count = 0;
+
+          // set the order of local processing
+          // local work is always first
+          std::iota(std::begin(porder_), std::end(porder_), 0);
+          std::shuffle(std::begin(porder_), std::end(porder_), this->rng0_);
+          std::swap(porder_[0], porder_[this->rank_]);
+
+          // tasks are claimed from the head of partition in chunks,
+          // while listener is giving away tail of the same partition
+          for (int rank = 0; rank < this->size_; ++rank) {
+              auto pos = porder_[rank];
+
+              do {
+                  curr_mtx_[pos].lock();
+
+                  int first = curr_head_[pos];
+                  int last = std::min<int>(first + PROCESS_CHUNK, curr_[pos].size());
+
+                  curr_head_[pos] = last;
+                  curr_size_.fetch_sub(last - first);
+
+                  curr_mtx_[pos].unlock();
+
+                  if (first == last) break;
+
+                  for (; first < last; ++first, ++count) {
+                      curr_[pos][first].process(ctx_, this->gst_);
+                      this->m_tick_bound__(this->gst_);
+                      this->m_tick_progress__();
+                  }
+              } while (true);
+          } // for rank
+
+          return count;
+      } // m_process_local_queue__
+
+      // moves new tasks to processing queue
+      long long int m_swap_queues__() {
+          long long int count = 0;
+
+          // tasks could be spilled while received in restart
+          if (!spill_next_.empty()) m_merge_spilled__();
 
-          // take care of global state
-          MPI_Allreduce(count, this->gcount_, 4, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+          for (int i = 0; i < this->size_; ++i) {
+              // merged spilled tasks go first
+              curr_[i].clear();
+              curr_[i].swap(merged_[i]);
+              curr_[i].reserve(curr_[i].size() + next_[i].size());
 
-          float sd = std::sqrt(this->gcount_[3] / this->size_);
-          float p_sd = (sd / mean) * 100;
+              while (!next_[i].empty()) {
+                  auto node = next_[i].extract(next_[i].begin());
+                  curr_[i].push_back(std::move(node.value()));
+              }
 
-          this->log().debug(this->NAME_) << "local tasks: " << this->gcount_[1]
-                                         << ", remote tasks: " << this->gcount_[2]
-                                         << ", standard deviation: "<< p_sd <<"%"
-                                         << std::endl;
+              // owner claims from the head, thieves take the tail, both start with the best tasks
+              impl::sort_by_priority_two_ends(curr_[i]);
 
-          long long int processed_task =  this->gcount_[1] + this->gcount_[2];
-          if (processed_task != global_tasks) {
-              this->log().error() << "something went very wrong, task numbers mismatch!" << std::endl;
+              curr_head_[i] = 0;
+              count += curr_[i].size();
           }
 
-          // get local queues in proper shape
-          // at this stage all ranks are in sync
-          this->tokens_.reset();
-          curr_.swap(next_);
-          curr_size_ = count[0];
+          curr_size_ = count;
+          next_size_ = 0;
 
-          mpi_impl::reduce(this->gst_, this->Comm_);
-          this->gst_.identity();
-          mpi_impl::broadcast(this->gst_, this->Comm_);
+          return count;
+      } // m_swap_queues__
 
-          this->giter_++;
+      // partition k of next_ is processed by this rank
+      bool m_spillable__(int k) const { return !this->cfg_.exchange_tasks || (k == this->rank_); }
 
-          return this->gcount_[0];
-      } // step
+      int m_spill_part__(const task_type& t) const { return std::hash<task_type>{}(t) % SPILL_PARTS; }
 
+      // called when partition k of next_ gains a new task,
+      // spills partitions of next_ processed by this rank if they exceed the budget
+      void m_tick_spill__(int k) {
+          if (!m_spillable__(k)) return;
+          if (++next_size_ * spill_next_.task_bytes() < budget_) return;
+          m_spill_next__();
+      } // m_tick_spill__
 
-  private:
-      using local_storage_type = std::vector<phmap::node_hash_set<task_type>>;
+      void m_spill_next__() {
+          SCOOL_TRACE_SCOPE("spill");
 
-      friend mpi_context<mpi_executor, Unique>;
-      mpi_context<mpi_executor, Unique> ctx_;
+          std::vector<std::vector<task_type>> P(SPILL_PARTS);
 
-      // this runs in listener thread
-      void m_request_listener__(MPI_Comm Comm) {
-          const int NUM_TRY = 3;
+          for (int i = 0; i < this->size_; ++i) {
+              if (!m_spillable__(i)) continue;
 
-          do {
-              auto [req, target] = this->m_receive_message_head__(Comm);
+              while (!next_[i].empty()) {
+                  auto node = next_[i].extract(next_[i].begin());
+                  int k = m_spill_part__(node.value());
 
-              if (req == this->REQ_FIN) break;
+                  P[k].push_back(std::move(node.value()));
 
-              if (req == this->REQ_ASK) {
-                  bool ans = false;
+                  if (P[k].size() == SPILL_BATCH) {
+                      spill_next_.write(k, std::begin(P[k]), std::end(P[k]));
+                      P[k].clear();
+                  }
+              }
+          } // for i
 
-                  if (curr_size_.load() > 0) {
-                      // perhaps we have something that can be stolen
-                      auto step = this->rng1_() % (this->size_ - 1);
+          for (int k = 0; k < SPILL_PARTS; ++k) spill_next_.write(k, std::begin(P[k]), std::end(P[k]));
 
-                      // let's make several attempts
-                      // first is always work local to target (thief)
-                      for (int i = 0; i < NUM_TRY; ++i) {
-                          int pos = (target + i * step) % (this->size_);
+          this->log().debug(this->NAME_) << "spilled " << spill_next_.size() << " tasks" << std::endl;
 
-                          if (curr_mtx_[pos].try_lock()) {
-                              // by the time we got lock, there may be no more work to do
-                              if (curr_[pos].empty()) {
-                                  curr_mtx_[pos].unlock();
-                                  break;
-                              }
+          next_size_ = 0;
+      } // m_spill_next__
 
-                              // serializing a batch
-                              this->m_send_message_head__(this->REQ_ANS, target, this->ANS_TAG, Comm);
-                              mpi_impl::serialize_and_send(curr_[pos].begin(), curr_[pos].end(), target, this->ANS_TAG, Comm);
+      // merges spilled tasks, and tasks still in memory, one hash partition at a time,
+      // merged tasks are grouped by owner in merged_
+      void m_merge_spilled__() {
+          SCOOL_TRACE_SCOPE("merge_spilled");
 
-                              int sz = curr_[pos].size();
-                              curr_[pos].clear();
+          for (int k = 0; k < SPILL_PARTS; ++k) {
+              if (spill_next_.size(k) == 0) continue;
 
-                              curr_size_.fetch_sub(sz);
-                              curr_mtx_[pos].unlock();
+              phmap::node_hash_set<task_type> S;
 
-                              ans = true;
-                              break;
-                          }
-                      } // for i
-                  } // if curr_size_
+              spill_next_.read(k, [&S](std::vector<task_type>& T) {
+                  for (auto& t : T) impl::add_to<Unique>(S, t);
+              });
+
+              for (auto& Q : next_) {
+                  for (auto it = Q.begin(); it != Q.end();) {
+                      if (m_spill_part__(*it) == k) {
+                          auto pos = it++;
+                          impl::add_to<Unique>(S, Q.extract(pos).value());
+                      } else ++it;
+                  }
+              } // for Q
 
-                  if (ans == false) this->m_send_message_head__(this->REQ_NONE, target, this->ANS_TAG, Comm);
-              } // if req = REQ_ASK
+              while (!S.empty()) {
+                  auto node = S.extract(S.begin());
+                  merged_[m_owner__(node.value())].push_back(std::move(node.value()));
+              }
+          } // for k
+      } // m_merge_spilled__
 
-          } while (true);
-      } // m_request_listener__
+      // owner rank of task t, see mpi_config::mapping
+      int m_owner__(const task_type& t) const {
+          if (this->cfg_.mapping == mpi_config::BALANCED) return pmap_(pt_(t));
+          return pt_(t) % static_cast<std::size_t>(this->size_);
+      } // m_owner__
 
-      int m_process_local_queue__() {
-          int count = 0;
+      // reassigns virtual partitions using the global number of new tasks in each,
+      // and moves tasks whose owner changed, all ranks must call it before exchange
+      void m_rebalance__() {
+          SCOOL_TRACE_SCOPE("rebalance");
 
-          // set the order of local processing
-          // local work is always first
-          std::iota(std::begin(porder_), std::end(porder_), 0);
-          std::shuffle(std::begin(porder_), std::end(porder_), this->rng0_);
-          std::swap(porder_[0], porder_[this->rank_]);
+          // the last entry counts spilled tasks, which are not assigned to virtual partitions
+          std::vector<long long int> w(pmap_.size() + 1, 0);
 
-          // this loop could be optimized to terminate earlier
-          // and with fewer curr_size_ loads
-          do {
-              for (int rank = 0; rank < this->size_; ++rank) {
-                  auto pos = porder_[rank];
+          for (auto& S : next_) {
+              for (auto& t : S) w[pmap_.vpart(pt_(t))]++;
+          }
 
-                  if (curr_mtx_[pos].try_lock()) {
-                      if (!curr_[pos].empty()) {
-                          auto iter = curr_[pos].begin();
-                          auto end = curr_[pos].end();
+          w.back() = spill_next_.size();
 
-                          for (; iter != end; ++iter, ++count) {
-                              iter->process(ctx_, this->gst_);
-                          }
+          MPI_Allreduce(MPI_IN_PLACE, w.data(), w.size(), MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
 
-                          int sz = curr_[pos].size();
-                          curr_[pos].clear();
+          // spilled tasks must stay with their owners
+          if (w.back() > 0) {
+              this->log().debug(this->NAME_) << "spilled tasks, partitions not rebalanced" << std::endl;
+              return;
+          }
 
-                          curr_size_.fetch_sub(sz);
-                      } // if curr_[pos]
+          w.pop_back();
 
-                      curr_mtx_[pos].unlock();
-                      if (curr_size_.load() <= 0) break;
-                  } // if try_lock
-              } // for rank
-          } while (curr_size_.load() > 0);
+          int moved = pmap_.rebalance(w);
 
-          return count;
-      } // m_process_local_queue__
+          std::vector<long long int> load(this->size_, 0);
+          for (int v = 0; v < pmap_.size(); ++v) load[pmap_.owner(v)] += w[v];
+
+          this->log().debug(this->NAME_) << "moved " << moved << " virtual partitions, max load: "
+                                         << *std::max_element(std::begin(load), std::end(load))
+                                         << ", total: " << std::accumulate(std::begin(load), std::end(load), 0LL)
+                                         << std::endl;
+
+          if (moved == 0) return;
 
-      /*
-        void m_deserialize_to_queue__(std::vector<char>&& data) {
-        scool::mpi_impl::deserialize_and_add<task_type, Unique>(data, next_[this->rank_]);
-        } // m_deserialize_to_queue__
+          // a task never shares set with its copy, so nodes can be moved without merging
+          for (int i = 0; i < this->size_; ++i) {
+              auto& S = next_[i];
 
-        void m_exchange_queues__() {
-        this->log().debug(this->NAME_) << "exchanging queues..." << std::endl;
+              for (auto it = S.begin(); it != S.end();) {
+                  int rank = pmap_(pt_(*it));
+                  if (rank == i) ++it;
+                  else {
+                      auto pos = it++;
+                      next_[rank].insert(S.extract(pos));
+                  }
+              }
+          } // for i
+      } // m_rebalance__
 
-        std::vector<char> data;
-        std::vector<char> rdata;
+      // sends tasks to their owners, duplicates are merged on arrival
+      // returns the number of received tasks
+      long long int m_exchange_queues__() {
+          SCOOL_TRACE_SCOPE("exchange");
+          SCOOL_PERF_SCOPE(this->mx_.hw_merge);
 
-        std::vector<int> scount(this->size_, 0);
-        std::vector<int> sdispl(this->size_, 0);
+          this->log().debug(this->NAME_) << "exchanging queues..." << std::endl;
 
-        std::future<void> ft;
+          std::vector<char> data;
+          archive::writer ar(data);
 
-        for (int i = 0; i < this->size_; ++i) {
-        data.clear();
+          std::vector<std::vector<std::size_t>> bounds(this->size_);
 
-        if (i != this->rank_) {
-        scool::mpi_impl::serialize(next_[i].begin(), next_[i].end(), data);
-        next_[i].clear();
-        }
+          for (int i = 0; i < this->size_; ++i) {
+              bounds[i].push_back(data.size());
+              if (i == this->rank_) continue;
 
-        int buf = data.size();
-        MPI_Gather(&buf, 1, MPI_INT, scount.data(), 1, MPI_INT, i, this->Comm_);
+              mpi_impl::serialize_frames(ar, next_[i].begin(), next_[i].end(), EXCHANGE_FRAME, bounds[i]);
+              this->mx_.tasks_exchanged += next_[i].size();
+              next_[i].clear();
+          }
 
-        if (i == this->rank_) {
-        std::partial_sum(std::begin(scount), std::end(scount) - 1, std::begin(sdispl) + 1);
-        rdata.resize(sdispl.back() + scount.back());
-        }
+          long long int n = 0;
 
-        MPI_Gatherv(data.data(), data.size(), MPI_CHAR, rdata.data(), scount.data(), sdispl.data(), MPI_CHAR, i, this->Comm_);
+          mpi_impl::alltoall_frames(data, bounds, this->cfg_.exchange_round_size, this->Comm_, [this, &n](std::vector<char>& buf) {
+              n += mpi_impl::deserialize_and_add<task_type, Unique>(buf, next_[this->rank_]);
 
-        if (i == this->rank_) {
-        ft = std::async(std::launch::async, &mpi_executor::m_deserialize_to_queue__, this, rdata);
-        }
-        } // for i
+              // received tasks count against the budget as well
+              if ((budget_ > 0) && (next_[this->rank_].size() * spill_next_.task_bytes() >= budget_)) m_spill_next__();
+          });
 
-          // we can swap now
-          ft.wait();
+          return n;
+      } // m_exchange_queues__
 
-          curr_.swap(next_);
-          curr_size_.store(curr_[this->rank_].size());
-          } // m_exchange_queues__
-      */
 
       std::atomic_int_fast32_t curr_size_;
       std::vector<std::mutex> curr_mtx_;
 
-      local_storage_type curr_;
+      queue_type curr_;
+      std::vector<int> curr_head_;
+
       local_storage_type next_;
 
+      // out-of-core part of next_, see memory_budget,
+      // spilled tasks are merged into merged_ before they are moved to curr_
+      std::size_t budget_ = 0;
+      std::size_t next_size_ = 0;
+
+      impl::spill_store<task_type> spill_next_{SPILL_PARTS};
+      queue_type merged_;
+
       std::vector<int> porder_;
       Partitioner pt_;
+      impl::partition_map pmap_;
+
+      // the number of tasks in a single exchange frame
+      static const int EXCHANGE_FRAME = 1024;
+
+      // the number of tasks claimed per lock in local processing
+      static const int PROCESS_CHUNK = 16;
+
+      // the number of spill files, and tasks buffered per file
+      static const int SPILL_PARTS = 16;
+      static const std::size_t SPILL_BATCH = 4096;
 
   }; // class mpi_executor
 
@@ -619,14 +1950,18 @@ namespace scool {
       using partitioner = Partitioner;
 
 
-      explicit mpi_executor(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1)
-          : mpi_executor_base__<TaskType, StateType, Partitioner>(Comm, seed), ctx_(*this) {
+      explicit mpi_executor(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1, const mpi_config& cfg = mpi_config())
+          : mpi_executor_base__<TaskType, StateType, Partitioner>(Comm, seed, cfg), ctx_(*this) {
 
           // we have separate communicator for requests processing
           MPI_Comm_dup(this->Comm_, &this->Comm_hlp_);
 
           // helper thread that acts as a request listener
-          this->hlp_th_ = std::thread(&mpi_executor::m_request_listener__, this, this->Comm_hlp_);
+          // one-sided stealing does not need it, and with one rank there is nothing to steal
+          if (this->cfg_.stealing == mpi_config::TWO_SIDED) this->m_start_listener__();
+          else if (this->size_ > 1) m_open_queue__();
+
+          this->relaxed_ = (this->cfg_.synchronization == mpi_config::RELAXED);
 
           // we have to synchronize, wait untill everybody is ready
           MPI_Barrier(this->Comm_);
@@ -634,39 +1969,89 @@ namespace scool {
           this->log().info(this->NAME_) << "ready with " << this->size_ << " ranks" << std::endl;
       } // mpi_executor
 
+      ~mpi_executor() {
+          if (head_win_ != MPI_WIN_NULL) {
+              MPI_Barrier(this->Comm_);
+              m_detach_queue__();
 
+              MPI_Win_unlock_all(data_win_);
+              MPI_Win_free(&data_win_);
+
+              MPI_Win_unlock_all(head_win_);
+              MPI_Win_free(&head_win_);
+          }
+      } // ~mpi_executor
+
+
+      // Function: init
+      // Initializes executor with a single task *t*, see below.
       void init(const task_type& t, const state_type& st,
                 const partitioner& pt = partitioner()) {
           std::vector<task_type> v{t};
-          init(std::begin(v), std::end(v), st);
+          init(std::begin(v), std::end(v), st, pt);
       } // init
 
+      // Function: init
+      // Initializes executor with tasks [first, last) given by rank 0, which scatters
+      // them across ranks according to <mpi_config::init_distribution>.
+      // The input on other ranks is ignored.
       template <typename Iter>
       void init(Iter first, Iter last, const state_type& st,
                 const partitioner& pt = partitioner()) {
-          if (this->rank_ == 0) {
-              this->gcount_[0] = 0;
-
-              for (; first != last; ++first, ++this->gcount_[0]) {
-                  impl::add_to<true>(curr_, *first);
-              }
-          }
-
-          this->gst_ = st;
-          this->lst_ = st;
-          this->rst_ = st;
-
-          hlp_pos_ = curr_.size();
-          curr_pos_ = 0;
-
-          goal_post_ = std::ceil(LOCAL_QUEUE_SIZE * curr_.size());
-
-          // to avoid data race between early stealing threads
-          MPI_Barrier(this->Comm_);
-
-          MPI_Bcast(&this->gcount_, 4, MPI_LONG_LONG_INT, 0, this->Comm_);
+          long long int n = this->m_scatter_tasks__(first, last, pt, curr_);
+          m_init__(n, st);
       } // init
 
+      // Function: init_local
+      // Initializes executor with tasks [first, last) supplied by each rank,
+      // i.e., every rank starts with its own slice of the input.
+      template <typename Iter>
+      void init_local(Iter first, Iter last, const state_type& st) {
+          for (; first != last; ++first) impl::add_to<true>(curr_, *first);
+          long long int count = curr_.size();
+          long long int n = 0;
+          MPI_Allreduce(&count, &n, 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+          m_init__(n, st);
+      } // init_local
+
+      // Function: restart
+      // Initializes executor from checkpoint *name* written by any executor,
+      // possibly with a different number of ranks. Use instead of <init>.
+      //
+      // Returns:
+      //   false if *name* is not a valid checkpoint.
+      bool restart(const std::string& name, const partitioner& /* pt */ = partitioner()) {
+          // blocks are spread round robin, and the partitioner is not needed
+          long long int count = this->m_read_checkpoint__(name, [this](task_type&& t) { curr_.push_back(std::move(t)); });
+          if (count < 0) return false;
+
+          long long int n = 0;
+          MPI_Allreduce(&count, &n, 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+
+          m_init__(n, this->gst_);
+
+          return true;
+      } // restart
+
+      // Function: depth_first
+      // Lets ctx.push() process a new task in place, depth first, instead of adding it
+      // to the next superstep, as long as the recursion is at most *depth* levels deep,
+      // and no steal request has been declined by this rank in the current superstep
+      // (with ONE_SIDED stealing, victims do not see requests). 0 disables depth-first
+      // processing (default), see <simple_executor::depth_first>.
+      void depth_first(int depth) { dfs_.limit(depth); }
+
+      // Function: memory_budget
+      // Limits memory used by tasks created in a superstep to about *bytes* per rank.
+      // Once the limit is exceeded, tasks are spilled in batches to scratch files in *dir*.
+      // In the next superstep, they are streamed back with read-ahead and processed
+      // before the local queue. Spilled tasks are not stolen. 0 means no limit (default).
+      void memory_budget(std::size_t bytes, const std::string& dir = "/tmp") {
+          budget_ = bytes;
+          spill_curr_.open(dir);
+          spill_next_.open(dir);
+      } // memory_budget
+
 
       long long int step() {
           this->log().info(this->NAME_) << "processing " << this->gcount_[0]
@@ -674,23 +2059,57 @@ namespace scool {
                                         << "..." << std::endl;
 
           long long int global_tasks  = this->gcount_[0];
-          long long int count[4] = {0, 0, 0, 0};
+          long long int count[5] = {0, 0, 0, 0, 0};
           long long int local_task;
 
-          MPI_Barrier(this->Comm_);
+          this->m_begin_metrics__();
+          this->m_barrier__();
 
           this->passive_.clear();
+          this->demand_.clear();
           this->lst_ = this->gst_;
           this->rst_ = this->gst_;
 
           // process local queue
-          count[1] = m_process_local_queue__();
+          auto t0 = std::chrono::steady_clock::now();
+
+          // spilled tasks are private, so others can steal from the queue meanwhile
+          count[1] = m_process_spilled__();
+
+          if (head_win_ == MPI_WIN_NULL) count[1] += m_process_local_queue__();
+          else count[1] += m_process_local_queue_rma__();
+
+          this->mx_.time_process = this->m_elapsed__(t0);
+          this->task_time_ += this->mx_.time_process;
+          this->task_count_ += count[1];
+
+          // tasks processed ahead, while the previous superstep was reduced
+          count[1] += early_[0];
 
           // go into stealing mode
-          count[2] = this->m_steal_tasks__(this->Comm_hlp_, ctx_);
+          auto process = [this](std::vector<task_type>& T) {
+              impl::sort_by_priority(std::begin(T), std::end(T));
+              for (auto& x : T) {
+                  x.process(ctx_, this->gst_);
+                  this->m_tick_bound__(this->gst_);
+                  this->m_tick_progress__();
+              }
+          };
+
+          t0 = std::chrono::steady_clock::now();
+
+          {
+              SCOOL_PERF_SCOPE(this->mx_.hw_steal);
+
+              if (head_win_ == MPI_WIN_NULL) count[2] = this->m_steal_tasks__(this->Comm_hlp_, process);
+              else count[2] = m_steal_tasks_rma__(process);
+          }
+
+          this->mx_.time_steal = this->m_elapsed__(t0);
 
           // take care of global state
-          count[0] = next_.size();
+          count[0] = next_.size() + spill_next_.size();
+          count[4] = early_[1];
 
           // calculate standard deviation
           local_task = count[1] + count[2];
@@ -700,26 +2119,41 @@ namespace scool {
 
           count[3] = std::llround(local_sq_diff);
 
-          MPI_Barrier(this->Comm_);
-          MPI_Allreduce(count, this->gcount_, 4, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+          long long int gcount[5];
+
+          if (this->relaxed_) m_overlap__(count, gcount);
+          else {
+              this->m_barrier__();
+
+              this->m_reduce_counts__(count, gcount, 5);
+          }
+
+          std::copy(gcount, gcount + 4, this->gcount_);
 
           // get local queues in proper shape
           this->tokens_.reset();
 
           curr_.swap(next_);
           next_.clear();
+          spill_curr_.swap(spill_next_);
+
+          // the best tasks go first to owner and to thieves
+          impl::sort_by_priority_two_ends(curr_);
+
+          this->m_set_granularity__(mtx_, curr_.size());
 
           hlp_pos_ = curr_.size();
           curr_pos_ = 0;
-          goal_post_ = std::ceil(LOCAL_QUEUE_SIZE * curr_.size());
+          goal_post_ = std::ceil(this->local_queue_size_ * curr_.size());
 
-          this->gst_.identity();
+          if (head_win_ != MPI_WIN_NULL) m_expose_queue__();
 
           float sd = std::sqrt(this->gcount_[3] / this->size_);
           float p_sd = (sd / mean) * 100;
 
+          // tasks created ahead were not part of global_tasks
           long long int processed_task =  this->gcount_[1] + this->gcount_[2];
-          if (processed_task != global_tasks) {
+          if (processed_task != global_tasks + gcount[4]) {
               this->log().error() << "something went very wrong, task numbers mismatch!" << std::endl;
           }
 
@@ -728,11 +2162,26 @@ namespace scool {
                                          << ", standard deviation: "<< std::setprecision(3) << p_sd << "%"
                                          << std::endl;
 
-          MPI_Barrier(this->Comm_);
-          mpi_impl::broadcast(this->gst_, this->Comm_);
+          // in RELAXED mode, state has been already reduced
+          if (!this->relaxed_) {
+              this->m_barrier__();
+              // without listener, state is reduced collectively
+              this->m_sync_state__(!this->hlp_th_.joinable());
+          }
 
           this->giter_++;
 
+          this->m_tick_checkpoint__([this](archive::writer& ar) {
+              impl::save_frames(ar, std::begin(curr_), std::end(curr_));
+              spill_curr_.copy_to(ar);
+          });
+
+          this->mx_.tasks_processed += local_task;
+          this->mx_.frontier_tasks = curr_.size() + spill_curr_.size();
+          this->mx_.frontier_bytes = curr_.size() * sizeof(task_type);
+
+          this->m_end_metrics__();
+
           return this->gcount_[0];
       } // step
 
@@ -744,69 +2193,199 @@ namespace scool {
       mpi_context<mpi_executor, true> ctx_;
 
 
-      // this runs in listener thread
-      void m_request_listener__(MPI_Comm Comm) {
-          do {
-              auto [req, target] = this->m_receive_message_head__(Comm);
+      using typename mpi_executor_base__<TaskType, StateType, Partitioner>::req_data_type;
+
+      // sets up the first superstep once curr_ holds local tasks, n is the global count
+      void m_init__(long long int n, const state_type& st) {
+          this->gcount_[0] = n;
+          this->gcount_[1] = this->gcount_[2] = this->gcount_[3] = 0;
+
+          this->gst_ = st;
+          this->pst_ = st;
+          this->lst_ = st;
+          this->rst_ = st;
+
+          impl::sort_by_priority_two_ends(curr_);
+
+          hlp_pos_ = curr_.size();
+          curr_pos_ = 0;
+
+          goal_post_ = std::ceil(this->local_queue_size_ * curr_.size());
 
-              if (req == this->REQ_FIN) break;
+          early_[0] = early_[1] = 0;
 
-              if (req == this->REQ_RDC) {
-                  state_type tmp_st = this->rst_;
-                  mpi_impl::receive_and_deserialize(tmp_st, target, this->RDC_TAG, Comm);
-                  this->rdc_mtx_.lock();
-                  this->rst_ += tmp_st;
-                  this->rdc_mtx_.unlock();
+          if (head_win_ != MPI_WIN_NULL) m_expose_queue__();
 
-                  if (this->passive_.test()) {
-                      if (this->rank_ != 0) this->gst_.identity();
-                      this->m_reduce_and_forward__(Comm);
+          // to avoid data race between early stealing threads
+          MPI_Barrier(this->Comm_);
+      } // m_init__
+
+      // processes t in place if depth-first budget allows, and nobody waits for work
+      bool m_dive__(const task_type& t) {
+          if (this->demand_.test() || !dfs_.enter()) return false;
+
+          task_type x = t;
+          x.process(ctx_, *dst_);
+
+          this->m_tick_bound__(*dst_);
+          this->m_tick_progress__();
+          this->mx_.tasks_processed++;
+
+          dfs_.leave();
+          return true;
+      } // m_dive__
+
+      // RELAXED synchronization: posts reductions of task counts and state, and until they
+      // complete processes the next frontier from its tail, with a private copy of state
+      void m_overlap__(long long int* count, long long int* gcount) {
+          SCOOL_TRACE_SCOPE("overlap");
+
+          MPI_Request req[2] = { MPI_REQUEST_NULL, MPI_REQUEST_NULL };
+          MPI_Iallreduce(count, gcount, 5, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_, &req[0]);
+
+          state_type sst = this->gst_;
+          state_type rst = sst;
+          if constexpr (archive::is_bitwise_v<state_type>) mpi_impl::iallreduce(sst, rst, this->Comm_, &req[1]);
+
+          ost_ = sst;
+          dst_ = &ost_;
+          early_[0] = 0;
+
+          long long int n = next_.size() + spill_next_.size();
+          auto t0 = std::chrono::steady_clock::now();
+
+          int flag = 0;
+
+          while (true) {
+              MPI_Testall(2, req, &flag, MPI_STATUSES_IGNORE);
+              if (flag) break;
+
+              if (next_.empty()) {
+                  if (this->cfg_.progress == mpi_config::POLLING) this->m_poll__();
+                  else {
+                      MPI_Waitall(2, req, MPI_STATUSES_IGNORE);
+                      break;
                   }
                   continue;
               }
 
-              if (req == this->REQ_ASK) {
-                  int start, end, batch, count;
+              task_type t = std::move(next_.back());
+              next_.pop_back();
 
-                  // calculating the batch size based on active ranks
-                  // more active ranks higher batch size (10.0% -> 1.0%)
-                  count = this->size_ - this->tokens_.count();
-                  task_batch_size = std::max((count / static_cast<float>(this->size_)) * 0.1, 0.01);
+              t.process(ctx_, ost_);
+              this->m_tick_bound__(ost_);
+              this->m_tick_progress__();
 
-                  mtx_.lock();
-                  batch = std::ceil((hlp_pos_ - goal_post_) * task_batch_size);
-                  start = hlp_pos_ - batch;
+              early_[0]++;
+          } // while
 
-                  if ((start <= goal_post_) || ((start - curr_pos_) < MIN_TASK_BATCH)) {
-                      mtx_.unlock();
-                      this->m_send_message_head__(this->REQ_NONE, target, this->ANS_TAG, Comm);
-                      continue;
-                  }
+          dst_ = &this->gst_;
 
-                  end = hlp_pos_;
-                  hlp_pos_ = start;
+          // tasks created while overlapping
+          early_[1] = next_.size() + spill_next_.size() + early_[0] - n;
 
+          // the reductions took at least as long as the loop
+          double dt = this->m_elapsed__(t0);
+
+          this->task_time_ += dt;
+          this->task_count_ += early_[0];
+          this->mx_.time_reduce += dt;
+
+          // listeners do not take part in reduction
+          if constexpr (archive::is_bitwise_v<state_type>) {
+              this->gst_ = rst;
+              this->gst_.identity();
+              this->pst_ = this->gst_;
+          } else this->m_sync_state__(true);
+
+          if (early_[0] > 0) this->gst_ += ost_;
+      } // m_overlap__
+
+      // this runs in listener thread, or in main thread when polling
+      void m_serve_request__(req_data_type req, int target, MPI_Comm Comm) override {
+          if (req == this->REQ_RDC) {
+              state_type tmp_st = this->rst_;
+              mpi_impl::receive_and_deserialize(tmp_st, target, this->RDC_TAG, Comm);
+              this->rdc_mtx_.lock();
+              this->rst_ += tmp_st;
+              this->rdc_mtx_.unlock();
+
+              if (this->passive_.test()) {
+                  if (this->rank_ != 0) this->gst_.identity();
+                  this->m_reduce_and_forward__(Comm);
+              }
+              return;
+          }
+
+          if (req == this->REQ_ASK) {
+              int start, end, batch, count;
+
+              // calculating the batch size based on active ranks and the cost model
+              count = this->size_ - this->tokens_.count();
+
+              mtx_.lock();
+              batch = std::ceil((hlp_pos_ - goal_post_) * this->m_steal_fraction__(hlp_pos_ - goal_post_, count));
+              batch = std::max(batch, this->min_steal_batch_);
+              start = hlp_pos_ - batch;
+
+              if ((start <= goal_post_) || ((start - curr_pos_) < this->task_chunk_)) {
                   mtx_.unlock();
+                  this->demand_.test_and_set();
+                  this->m_send_message_head__(this->REQ_NONE, target, this->ANS_TAG, Comm);
+                  return;
+              }
 
-                  this->m_send_message_head__(this->REQ_ANS, target, this->ANS_TAG, Comm);
+              end = hlp_pos_;
+              hlp_pos_ = start;
 
-                  auto first = std::next(curr_.begin(), hlp_pos_);
-                  auto last = std::next(curr_.begin(), end);
+              mtx_.unlock();
 
-                  mpi_impl::serialize_and_send(first, last, target, this->ANS_TAG, Comm);
-              } // if req == REQ_ASK
+              auto first = std::next(curr_.begin(), hlp_pos_);
+              auto last = std::next(curr_.begin(), end);
 
-          } while (true);
-      } // m_request_listener__
+              this->m_send_answer__(first, last, target, Comm);
+          } // if req == REQ_ASK
+      } // m_serve_request__
 
 
+      // streams spilled tasks of the current superstep
+      int m_process_spilled__() {
+          SCOOL_TRACE_SCOPE("process_spilled");
+          SCOOL_PERF_SCOPE(this->mx_.hw_process);
+
+          int count = 0;
+
+          spill_curr_.read(0, [this, &count](std::vector<task_type>& T) {
+              for (auto& x : T) {
+                  x.process(ctx_, this->gst_);
+                  this->m_tick_bound__(this->gst_);
+                  this->m_tick_progress__();
+              }
+              count += T.size();
+          });
+
+          return count;
+      } // m_process_spilled__
+
+      // spills next_ if it exceeds the budget
+      void m_tick_spill__() {
+          if (next_.size() * spill_next_.task_bytes() < budget_) return;
+          spill_next_.write(0, std::begin(next_), std::end(next_));
+          next_.clear();
+      } // m_tick_spill__
+
       // this runs in main thread
       int m_process_local_queue__() {
+          SCOOL_TRACE_SCOPE("process_local_queue");
+          SCOOL_PERF_SCOPE(this->mx_.hw_process);
+
           int S = 0;
 
           // 1. process local portion of the queue
           while (curr_pos_ < goal_post_) {
               curr_[curr_pos_].process(ctx_, this->gst_);
+              this->m_tick_bound__(this->gst_);
+              this->m_tick_progress__();
               curr_pos_++;
               S++;
           }
@@ -822,23 +2401,275 @@ namespace scool {
               }
 
               pos = curr_pos_;
-              curr_pos_ = std::min(curr_pos_ + MIN_TASK_BATCH, hlp_pos_);
+              curr_pos_ = std::min(curr_pos_ + this->task_chunk_, hlp_pos_);
 
               mtx_.unlock();
 
-              for (; pos < curr_pos_; ++pos, ++S) curr_[pos].process(ctx_, this->gst_);
+              for (; pos < curr_pos_; ++pos, ++S) {
+                  curr_[pos].process(ctx_, this->gst_);
+                  this->m_tick_bound__(this->gst_);
+                  this->m_tick_progress__();
+              }
           }
 
           return S;
       } // m_process_local_queue__
 
+      // one-sided stealing
+      // every rank exposes header with claim counter, and its queue [goal_post_, size)
+      // owner claims tasks from the head of the queue, thieves from the tail,
+      // both with MPI_Fetch_and_op on the same packed counter
+      // victims are not involved, and there is no listener thread
+
+      // header: claim counter (tasks claimed by owner in low, by thieves in high 32 bits),
+      // queue size, goal post, address of data, address of offsets
+      struct rma_head {
+          std::uint64_t n = 0;
+          std::uint64_t goal = 0;
+          std::uint64_t daddr = 0;
+          std::uint64_t oaddr = 0;
+          std::int64_t avail = 0;
+      }; // struct rma_head
+
+      void m_open_queue__() {
+          std::uint64_t* base = nullptr;
+
+          MPI_Win_allocate(HEAD_SIZE * sizeof(std::uint64_t), sizeof(std::uint64_t),
+                           MPI_INFO_NULL, this->Comm_, &base, &head_win_);
+          head_ = base;
+          std::fill(head_, head_ + HEAD_SIZE, 0);
+
+          MPI_Win_create_dynamic(MPI_INFO_NULL, this->Comm_, &data_win_);
+
+          // passive target epochs for the entire lifetime
+          MPI_Win_lock_all(MPI_MODE_NOCHECK, head_win_);
+          MPI_Win_lock_all(MPI_MODE_NOCHECK, data_win_);
+
+          rhead_.resize(this->size_);
+      } // m_open_queue__
+
+      // publishes curr_ for thieves, must be followed by a barrier
+      // bitwise tasks are exposed in place, other tasks are serialized with offsets
+      void m_expose_queue__() {
+          m_detach_queue__();
+
+          rma_data_.clear();
+          rma_offs_.clear();
+
+          std::uint64_t n = curr_.size();
+          std::uint64_t goal = goal_post_;
+
+          MPI_Aint daddr = 0;
+          MPI_Aint oaddr = 0;
+
+          if (goal < n) {
+              if constexpr (archive::is_bitwise_v<task_type>) {
+                  m_attach__(curr_.data(), n * sizeof(task_type));
+                  MPI_Get_address(curr_.data(), &daddr);
+              } else {
+                  archive::writer ar(rma_data_);
+
+                  rma_offs_.reserve(n - goal + 1);
+
+                  for (auto i = goal; i < n; ++i) {
+                      rma_offs_.push_back(ar.size());
+                      archive::save(ar, curr_[i]);
+                  }
+
+                  rma_offs_.push_back(ar.size());
+
+                  m_attach__(rma_data_.data(), rma_data_.size());
+                  m_attach__(rma_offs_.data(), rma_offs_.size() * sizeof(std::uint64_t));
+
+                  MPI_Get_address(rma_data_.data(), &daddr);
+                  MPI_Get_address(rma_offs_.data(), &oaddr);
+              }
+          } // if goal
+
+          // nothing to claim below goal post
+          head_[0] = goal;
+          head_[1] = n;
+          head_[2] = goal;
+          head_[3] = daddr;
+          head_[4] = oaddr;
+
+          MPI_Win_sync(head_win_);
+
+          std::fill(std::begin(rhead_), std::end(rhead_), rma_head{});
+      } // m_expose_queue__
+
+      void m_attach__(void* p, std::size_t sz) {
+          if (sz == 0) return;
+          MPI_Win_attach(data_win_, p, sz);
+          attached_.push_back(p);
+      } // m_attach__
+
+      void m_detach_queue__() {
+          for (auto p : attached_) MPI_Win_detach(data_win_, p);
+          attached_.clear();
+      } // m_detach_queue__
+
+      // adds claim to counter of target
+      // returns [head, tail) range of the queue that was unclaimed at that time
+      std::pair<std::uint64_t, std::uint64_t> m_claim__(int target, std::uint64_t claim, std::uint64_t n) {
+          std::uint64_t old = 0;
+
+          MPI_Fetch_and_op(&claim, &old, MPI_UINT64_T, target, 0, MPI_SUM, head_win_);
+          MPI_Win_flush(target, head_win_);
+
+          return { old & CLAIM_MASK, n - std::min(n, old >> 32) };
+      } // m_claim__
+
+      int m_process_local_queue_rma__() {
+          SCOOL_TRACE_SCOPE("process_local_queue");
+          SCOOL_PERF_SCOPE(this->mx_.hw_process);
+
+          int S = 0;
+
+          // 1. process local portion of the queue
+          for (; curr_pos_ < goal_post_; ++curr_pos_, ++S) {
+              curr_[curr_pos_].process(ctx_, this->gst_);
+              this->m_tick_bound__(this->gst_);
+          }
+
+          // 2. claim chunks of the shared portion
+          std::uint64_t n = curr_.size();
+
+          while (true) {
+              auto [first, last] = m_claim__(this->rank_, this->task_chunk_, n);
+              last = std::min<std::uint64_t>(last, first + this->task_chunk_);
+
+              if (first >= last) break;
+
+              for (; first < last; ++first, ++S) {
+                  curr_[first].process(ctx_, this->gst_);
+                  this->m_tick_bound__(this->gst_);
+              }
+          }
+
+          return S;
+      } // m_process_local_queue_rma__
+
+      // fetches header of target, and atomically reads its counter
+      rma_head m_read_head__(int target) {
+          auto& h = rhead_[target];
+
+          std::uint64_t zero = 0;
+          std::uint64_t claim = 0;
+
+          if (h.n == 0) MPI_Get(&h, HEAD_SIZE - 1, MPI_UINT64_T, target, 1, HEAD_SIZE - 1, MPI_UINT64_T, head_win_);
+          MPI_Fetch_and_op(&zero, &claim, MPI_UINT64_T, target, 0, MPI_NO_OP, head_win_);
+          MPI_Win_flush(target, head_win_);
+
+          rma_head res = h;
+          res.avail = std::max<std::int64_t>(0, static_cast<std::int64_t>(h.n - (claim >> 32)) - static_cast<std::int64_t>(claim & CLAIM_MASK));
+
+          return res;
+      } // m_read_head__
+
+      // claims tail of target's queue, and pulls it into T
+      // active is the number of ranks that may still have work
+      bool m_steal_rma__(int target, std::vector<task_type>& T, int active) {
+          auto h = m_read_head__(target);
+          if (h.avail == 0) return false;
+
+          std::int64_t batch = std::ceil(h.avail * this->m_steal_fraction__(h.avail, active));
+          batch = std::max<std::int64_t>(batch, this->min_steal_batch_);
+
+          // do not take work that victim is about to process
+          if (h.avail - batch < this->task_chunk_) return false;
+
+          auto [head, tail] = m_claim__(target, static_cast<std::uint64_t>(batch) << 32, h.n);
+          std::uint64_t first = std::max<std::uint64_t>(head, tail - std::min<std::uint64_t>(tail, batch));
+
+          if ((tail <= head) || (first >= tail)) return false;
+
+          std::uint64_t n = tail - first;
+
+          if constexpr (archive::is_bitwise_v<task_type>) {
+              auto pos = T.size();
+              T.resize(pos + n);
+
+              MPI_Aint addr = MPI_Aint_add(h.daddr, first * sizeof(task_type));
+              MPI_Get(T.data() + pos, n * sizeof(task_type), MPI_BYTE, target, addr, n * sizeof(task_type), MPI_BYTE, data_win_);
+              MPI_Win_flush(target, data_win_);
+
+              this->mx_.steal_bytes += n * sizeof(task_type);
+          } else {
+              std::vector<std::uint64_t> offs(n + 1);
+
+              MPI_Aint addr = MPI_Aint_add(h.oaddr, (first - h.goal) * sizeof(std::uint64_t));
+              MPI_Get(offs.data(), n + 1, MPI_UINT64_T, target, addr, n + 1, MPI_UINT64_T, data_win_);
+              MPI_Win_flush(target, data_win_);
+
+              std::vector<char> data(offs[n] - offs[0]);
+
+              addr = MPI_Aint_add(h.daddr, offs[0]);
+              MPI_Get(data.data(), data.size(), MPI_BYTE, target, addr, data.size(), MPI_BYTE, data_win_);
+              MPI_Win_flush(target, data_win_);
+
+              this->mx_.steal_bytes += data.size();
+
+              archive::reader ar(data);
+
+              for (std::uint64_t i = 0; i < n; ++i) {
+                  T.emplace_back();
+                  archive::load(ar, T.back());
+              }
+          }
+
+          return true;
+      } // m_steal_rma__
+
+      // queues do not refill during superstep, so stealing ends
+      // once every victim was found empty
+      template <typename Process>
+      int m_steal_tasks_rma__(Process process) {
+          SCOOL_TRACE_SCOPE("steal");
+
+          int count = 0;
+
+          std::vector<task_type> T;
+
+          int lend = this->m_set_vranks__();
+          int end = this->size_ - 1;
+
+          while (end > 0) {
+              int pos = this->m_pick_victim__(lend, end);
+              int target = this->vranks_[pos];
+
+              auto t0 = std::chrono::steady_clock::now();
+
+              bool res = m_steal_rma__(target, T, end);
+
+              this->steal_time_ += this->m_elapsed__(t0);
+              this->steal_count_++;
+              this->mx_.steal_attempts++;
+
+              if (res) {
+                  this->mx_.steal_successes++;
+                  this->mx_.tasks_stolen += T.size();
+
+                  t0 = std::chrono::steady_clock::now();
+
+                  process(T);
+                  count += T.size();
+
+                  this->task_time_ += this->m_elapsed__(t0);
+                  this->task_count_ += T.size();
+
+                  T.clear();
+              } else this->m_remove_victim__(pos, lend, end);
+          } // while end
+
+          return count;
+      } // m_steal_tasks_rma__
+
 
       // queue indexes
       int goal_post_ = 0;
       int curr_pos_ = 0;
       int hlp_pos_ = 0;
-      // stealing chunk size
-      float task_batch_size = 0.10;
 
       std::mutex mtx_;
 
@@ -846,12 +2677,38 @@ namespace scool {
       local_storage_type curr_;
       local_storage_type next_;
 
-      // local queue size
-      const float LOCAL_QUEUE_SIZE = 0.20;
+      // out-of-core part of queues, see memory_budget
+      std::size_t budget_ = 0;
+
+      impl::spill_store<task_type> spill_curr_;
+      impl::spill_store<task_type> spill_next_;
+
+      // RELAXED synchronization, private state of tasks processed ahead,
+      // and the number of tasks processed and created ahead
+      state_type ost_;
+      long long int early_[2] = { 0, 0 };
+
+      // depth-first budget, and state used by tasks processed in place
+      impl::dfs_budget dfs_;
+      state_type* dst_ = &this->gst_;
+
+      // one-sided stealing
+      static const int HEAD_SIZE = 5;
+      static const std::uint64_t CLAIM_MASK = 0xFFFFFFFF;
+
+      MPI_Win head_win_ = MPI_WIN_NULL;
+      MPI_Win data_win_ = MPI_WIN_NULL;
+
+      std::uint64_t* head_ = nullptr;
+
+      // headers of victims, fetched once per superstep
+      std::vector<rma_head> rhead_;
+
+      // serialized queue and offsets of tasks in it
+      std::vector<char> rma_data_;
+      std::vector<std::uint64_t> rma_offs_;
 
-      // local thread - locks 10 tasks at a time
-      // helper thread - allow stealing if tasks > MIN_TASK_BATCH
-      const int MIN_TASK_BATCH = 10;
+      std::vector<void*> attached_;
 
   }; // class mpi_executor
 
@@ -15,14 +15,21 @@
 #ifndef MPI_IMPL_HPP
 #define MPI_IMPL_HPP
 
-#include <istream>
-#include <ostream>
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <type_traits>
+#include <vector>
 
 #include <mpi.h>
 
+#include "archive.hpp"
 #include "impl.hpp"
-#include "utility.hpp"
 
 
 namespace scool {
@@ -31,107 +38,350 @@ namespace scool {
 
     template <typename Iter>
     void serialize(Iter first, Iter last, std::vector<char>& buf) {
-        scool::util::fast_vector_obuf<char> ob(buf);
-        std::ostream os(&ob);
+        buf.clear();
+        if (first == last) return;
 
-        if (first == last) {
-            buf.clear();
-            return;
-        }
-
-        for (; first != last; ++first) os << *first;
+        archive::writer ar(buf);
+        archive::save_range(ar, first, last);
     } // serialize
 
 
+    // returns the number of deserialized objects
     template <typename T, bool Unique, typename Container>
-    void deserialize_and_add(std::vector<char>& data, Container& S) {
-        if (data.empty()) return;
+    long long int deserialize_and_add(std::vector<char>& data, Container& S) {
+        if (data.empty()) return 0;
 
-        scool::util::fast_vector_ibuf<char> ib(data);
-        std::istream is(&ib);
+        archive::reader ar(data);
+        long long int n = 0;
 
-        while (!is.eof()) {
-            T t;
-            is >> t;
-            impl::add_to<Unique>(S, t);
+        while (!ar.empty()) {
+            archive::for_each<T>(ar, [&S, &n](T&& t) { impl::add_to<Unique>(S, t); ++n; });
         }
+
+        return n;
     } // deserialize_and_add
 
+    // serializes [first, last) as a sequence of frames holding at most n objects each
+    // offset at which every frame ends is appended to bounds
+    template <typename Iter>
+    void serialize_frames(archive::writer& ar, Iter first, Iter last, int n, std::vector<std::size_t>& bounds) {
+        while (first != last) {
+            auto it = first;
+            for (int i = 0; (i < n) && (it != last); ++i) ++it;
+
+            archive::save_range(ar, first, it);
+            bounds.push_back(ar.size());
+
+            first = it;
+        }
+    } // serialize_frames
+
+
+    // appends [first, last) to ar using the range wire format:
+    // raw objects if they are trivially copyable, archive range otherwise
+    template <typename Iter>
+    void pack_range(archive::writer& ar, Iter first, Iter last) {
+        using T = std::iter_value_t<Iter>;
+
+        if constexpr (archive::is_bitwise_v<T>) {
+            if constexpr (std::contiguous_iterator<Iter>) {
+                ar.write(std::to_address(first), (last - first) * sizeof(T));
+            } else {
+                for (; first != last; ++first) archive::save(ar, *first);
+            }
+        } else archive::save_range(ar, first, last);
+    } // pack_range
+
+    // complements pack_range, consumes ar and appends to v
+    template <typename T, typename Alloc>
+    void unpack_range(archive::reader& ar, std::vector<T, Alloc>& v) {
+        if constexpr (archive::is_bitwise_v<T>) {
+            auto n = ar.size();
+            auto pos = v.size();
+            v.resize(pos + n / sizeof(T));
+            ar.read(v.data() + pos, n);
+        } else {
+            while (!ar.empty()) archive::load_range(ar, v);
+        }
+    } // unpack_range
+
+
+    // describes two memory regions as one absolute MPI datatype
+    inline MPI_Datatype make_parts_type(const void* p0, int n0, const void* p1, int n1) {
+        MPI_Aint displ[2];
+        int len[2] = { n0, n1 };
+
+        MPI_Get_address(const_cast<void*>(p0), &displ[0]);
+        MPI_Get_address(const_cast<void*>(p1), &displ[1]);
+
+        MPI_Datatype T;
+        MPI_Type_create_hindexed(2, len, displ, MPI_BYTE, &T);
+        MPI_Type_commit(&T);
+
+        return T;
+    } // make_parts_type
+
+    // sends two memory regions as a single message without packing
+    inline void send_parts(const void* p0, int n0, const void* p1, int n1, int rank, int Tag, MPI_Comm Comm) {
+        if (n1 == 0) {
+            MPI_Send(p0, n0, MPI_BYTE, rank, Tag, Comm);
+            return;
+        }
+
+        auto T = make_parts_type(p0, n0, p1, n1);
+        MPI_Send(MPI_BOTTOM, 1, T, rank, Tag, Comm);
+        MPI_Type_free(&T);
+    } // send_parts
+
+    // receives message sent via send_parts scattering it into two memory regions
+    inline void receive_parts(void* p0, int n0, void* p1, int n1, int rank, int Tag, MPI_Comm Comm) {
+        MPI_Status stat;
+
+        if (n1 == 0) {
+            MPI_Recv(p0, n0, MPI_BYTE, rank, Tag, Comm, &stat);
+            return;
+        }
+
+        auto T = make_parts_type(p0, n0, p1, n1);
+        MPI_Recv(MPI_BOTTOM, 1, T, rank, Tag, Comm, &stat);
+        MPI_Type_free(&T);
+    } // receive_parts
+
+    // blocks until message from rank is available and returns its size in bytes
+    inline int probe_size(int rank, int Tag, MPI_Comm Comm) {
+        MPI_Status stat;
+        MPI_Probe(rank, Tag, Comm, &stat);
+
+        int sz = 0;
+        MPI_Get_count(&stat, MPI_BYTE, &sz);
+
+        return sz;
+    } // probe_size
+
+
+    // largest payload of a single point-to-point message
+    inline constexpr std::size_t MAX_MESSAGE_SIZE = std::numeric_limits<int>::max();
+
+    // sends byte count n followed by n bytes from p
+    // payloads over MAX_MESSAGE_SIZE are split into several messages
+    inline void send_bytes(const void* p, std::size_t n, int rank, int Tag, MPI_Comm Comm) {
+        std::uint64_t buf = n;
+        MPI_Send(&buf, 1, MPI_UINT64_T, rank, Tag, Comm);
+
+        auto ptr = static_cast<const char*>(p);
+
+        for (std::size_t pos = 0; pos < n; pos += MAX_MESSAGE_SIZE) {
+            int sz = std::min(n - pos, MAX_MESSAGE_SIZE);
+            MPI_Send(ptr + pos, sz, MPI_BYTE, rank, Tag, Comm);
+        }
+    } // send_bytes
+
+    // receives byte count sent via send_bytes
+    inline std::size_t receive_bytes_count(int rank, int Tag, MPI_Comm Comm) {
+        MPI_Status stat;
+
+        std::uint64_t buf = 0;
+        MPI_Recv(&buf, 1, MPI_UINT64_T, rank, Tag, Comm, &stat);
+
+        return buf;
+    } // receive_bytes_count
+
+    // receives n bytes sent via send_bytes into p
+    inline void receive_bytes(void* p, std::size_t n, int rank, int Tag, MPI_Comm Comm) {
+        MPI_Status stat;
+
+        auto ptr = static_cast<char*>(p);
+
+        for (std::size_t pos = 0; pos < n; pos += MAX_MESSAGE_SIZE) {
+            int sz = std::min(n - pos, MAX_MESSAGE_SIZE);
+            MPI_Recv(ptr + pos, sz, MPI_BYTE, rank, Tag, Comm, &stat);
+        }
+    } // receive_bytes
+
+
+    inline void send_buffer(const std::vector<char>& data, int rank, int Tag, MPI_Comm Comm) {
+        send_bytes(data.data(), data.size(), rank, Tag, Comm);
+    } // send_buffer
+
+    inline bool receive_buffer(std::vector<char>& data, int rank, int Tag, MPI_Comm Comm) {
+        auto buf = receive_bytes_count(rank, Tag, Comm);
+
+        data.resize(buf);
+        if (buf == 0) return false;
+
+        receive_bytes(data.data(), buf, rank, Tag, Comm);
+
+        return true;
+    } // receive_buffer
+
 
     template <typename T>
     void serialize_and_send(const T& t, int rank, int Tag, MPI_Comm Comm) {
         std::vector<char> data;
 
-        scool::util::fast_vector_obuf<char> ob(data);
-        std::ostream os(&ob);
-        os << t;
+        archive::writer ar(data);
+        archive::save(ar, t);
 
-        int buf = data.size();
-
-        MPI_Send(&buf, 1, MPI_INT, rank, Tag, Comm);
-        if (buf > 0) MPI_Send(data.data(), buf, MPI_CHAR, rank, Tag, Comm);
+        send_buffer(data, rank, Tag, Comm);
     } // serialize_and_send
 
+    // ranges of trivially copyable objects are sent raw, without framing
     template <typename Iter>
     void serialize_and_send(Iter first, Iter last, int rank, int Tag, MPI_Comm Comm) {
-        std::vector<char> data;
-        serialize(first, last, data);
+        using T = std::iter_value_t<Iter>;
 
-        int buf = data.size();
+        if constexpr (archive::is_bitwise_v<T> && std::contiguous_iterator<Iter>) {
+            // no packing, we send directly from the storage
+            std::size_t buf = (last - first) * sizeof(T);
+            send_bytes(std::to_address(first), buf, rank, Tag, Comm);
+        } else {
+            std::vector<char> data;
+
+            archive::writer ar(data);
+            if (first != last) pack_range(ar, first, last);
 
-        MPI_Send(&buf, 1, MPI_INT, rank, Tag, Comm);
-        if (buf > 0) MPI_Send(data.data(), buf, MPI_CHAR, rank, Tag, Comm);
+            send_buffer(data, rank, Tag, Comm);
+        }
     } // serialize_and_send
 
 
     template <typename T>
     bool receive_and_deserialize(T& t, int rank, int Tag, MPI_Comm Comm) {
-        MPI_Status stat;
+        std::vector<char> data;
+        if (!receive_buffer(data, rank, Tag, Comm)) return false;
 
-        int buf = 0;
-        MPI_Recv(&buf, 1, MPI_INT, rank, Tag, Comm, &stat);
+        archive::reader ar(data);
+        archive::load(ar, t);
 
-        if (buf == 0) return false;
+        return true;
+    } // receive_and_deserialize
 
+    template <typename T, typename Output>
+    bool receive_and_deserialize(Output out, int rank, int Tag, MPI_Comm Comm) {
         std::vector<char> data;
-        data.resize(buf);
-
-        MPI_Recv(data.data(), buf, MPI_CHAR, rank, Tag, Comm, &stat);
+        if (!receive_buffer(data, rank, Tag, Comm)) return false;
 
-        scool::util::fast_vector_ibuf<char> ib(data);
-        std::istream is(&ib);
+        archive::reader ar(data);
 
-        is >> t;
+        if constexpr (archive::is_bitwise_v<T>) {
+            while (!ar.empty()) {
+                T t;
+                archive::load(ar, t);
+                *(out++) = std::move(t);
+            }
+        } else archive::load_range<T>(ar, out);
 
         return true;
     } // receive_and_deserialize
 
-    template <typename T, typename Output>
-    bool receive_and_deserialize(Output out, int rank, int Tag, MPI_Comm Comm) {
-        MPI_Status stat;
+    // receives range sent via serialize_and_send, and appends it to v
+    // trivially copyable objects land directly in v
+    // returns the payload size in bytes, 0 if the range was empty
+    template <typename T, typename Alloc>
+    std::size_t receive_range(std::vector<T, Alloc>& v, int rank, int Tag, MPI_Comm Comm) {
+        auto buf = receive_bytes_count(rank, Tag, Comm);
+        if (buf == 0) return 0;
+
+        if constexpr (archive::is_bitwise_v<T>) {
+            auto pos = v.size();
+            v.resize(pos + buf / sizeof(T));
+            receive_bytes(v.data() + pos, buf, rank, Tag, Comm);
+        } else {
+            std::vector<char> data(buf);
+            receive_bytes(data.data(), buf, rank, Tag, Comm);
 
-        int buf = 0;
-        MPI_Recv(&buf, 1, MPI_INT, rank, Tag, Comm, &stat);
+            archive::reader ar(data);
+            unpack_range(ar, v);
+        }
 
-        if (buf == 0) return false;
+        return buf;
+    } // receive_range
+
+    // all-to-all exchange of framed data in rounds
+    // frames for rank i are in data between consecutive offsets in bounds[i]
+    // each rank sends at most round_size bytes per round (but at least one frame per peer),
+    // and fun is called on data received in a round while the next round is in flight
+    // if data exceeds 2GB, every round is staged in its own buffer, such that int displacements suffice
+    template <typename Fun>
+    void alltoall_frames(const std::vector<char>& data, const std::vector<std::vector<std::size_t>>& bounds,
+                         std::size_t round_size, MPI_Comm Comm, Fun fun) {
+        // leaves room for one frame per peer above the limit
+        const std::size_t MAX_ROUND_SIZE = std::numeric_limits<int>::max() / 2;
+
+        int size;
+        MPI_Comm_size(Comm, &size);
 
-        std::vector<char> data;
-        data.resize(buf);
+        std::size_t peer_size = std::max<std::size_t>(std::min(round_size, MAX_ROUND_SIZE) / size, 1);
 
-        MPI_Recv(data.data(), buf, MPI_CHAR, rank, Tag, Comm, &stat);
+        // split frames for each peer into rounds
+        std::vector<std::vector<std::size_t>> rounds(size);
+        int R = 0;
 
-        scool::util::fast_vector_ibuf<char> ib(data);
-        std::istream is(&ib);
+        for (int i = 0; i < size; ++i) {
+            auto& b = bounds[i];
+            auto& rb = rounds[i];
 
-        while (!is.eof()) {
-            T t;
-            is >> t;
-            if (!is) break;
-            *(out++) = std::move(t);
-        }
+            rb.push_back(b[0]);
 
-        return true;
-    } // receive_and_deserialize
+            for (std::size_t k = 1; k < b.size(); ++k) {
+                if ((b[k] - rb.back() > peer_size) && (b[k - 1] != rb.back())) rb.push_back(b[k - 1]);
+            }
+
+            if (b.back() != rb.back()) rb.push_back(b.back());
+
+            R = std::max<int>(R, rb.size() - 1);
+        } // for i
+
+        MPI_Allreduce(MPI_IN_PLACE, &R, 1, MPI_INT, MPI_MAX, Comm);
+
+        std::vector<int> scount(size), sdispl(size);
+        std::vector<int> rcount(size), rdispl(size);
+
+        // the previous round is completed before the next one is staged
+        bool staged = (data.size() > static_cast<std::size_t>(std::numeric_limits<int>::max()));
+
+        std::vector<char> sbuf;
+        std::vector<char> rbuf[2];
+        MPI_Request req;
+
+        for (int r = 0; r <= R; ++r) {
+            int cur = r & 1;
+
+            if (r < R) {
+                sbuf.clear();
+
+                for (int i = 0; i < size; ++i) {
+                    sdispl[i] = 0;
+                    scount[i] = 0;
+
+                    if (r + 1 < static_cast<int>(rounds[i].size())) {
+                        scount[i] = rounds[i][r + 1] - rounds[i][r];
+
+                        if (staged) {
+                            sdispl[i] = sbuf.size();
+                            auto first = std::begin(data) + rounds[i][r];
+                            sbuf.insert(std::end(sbuf), first, first + scount[i]);
+                        } else sdispl[i] = rounds[i][r];
+                    }
+                } // for i
+
+                MPI_Alltoall(scount.data(), 1, MPI_INT, rcount.data(), 1, MPI_INT, Comm);
+
+                rdispl[0] = 0;
+                std::partial_sum(std::begin(rcount), std::end(rcount) - 1, std::begin(rdispl) + 1);
+
+                rbuf[cur].resize(rdispl.back() + rcount.back());
+
+                MPI_Ialltoallv(staged ? sbuf.data() : data.data(), scount.data(), sdispl.data(), MPI_BYTE,
+                               rbuf[cur].data(), rcount.data(), rdispl.data(), MPI_BYTE, Comm, &req);
+            }
+
+            // previous round overlaps with the current one
+            if (r > 0) fun(rbuf[1 - cur]);
+
+            if (r < R) MPI_Wait(&req, MPI_STATUS_IGNORE);
+        } // for r
+    } // alltoall_frames
 
     template <typename T> void reduce(T& t, MPI_Comm Comm) {
         const int RDC_TAG = 1101;
@@ -164,6 +414,59 @@ namespace scool {
 
     } // reduce
 
+    // MPI_Op applying T::operator+= to states copied as raw bytes
+    template <typename T> void state_op(void* in, void* inout, int* len, MPI_Datatype*) {
+        auto x = static_cast<const char*>(in);
+        auto y = static_cast<char*>(inout);
+
+        T a, b;
+
+        for (int i = 0; i < *len; ++i, x += sizeof(T), y += sizeof(T)) {
+            std::memcpy(&a, x, sizeof(T));
+            std::memcpy(&b, y, sizeof(T));
+            a += b;
+            std::memcpy(y, &a, sizeof(T));
+        }
+    } // state_op
+
+    // reduces t over all ranks with a single collective,
+    // T must be copyable as raw bytes, i.e., archive::is_bitwise_v<T>
+    template <typename T> void allreduce(T& t, MPI_Comm Comm) {
+        static_assert(archive::is_bitwise_v<T>, "allreduce requires trivially copyable type");
+
+        MPI_Datatype Type;
+        MPI_Type_contiguous(sizeof(T), MPI_BYTE, &Type);
+        MPI_Type_commit(&Type);
+
+        // states are commutative monoids
+        MPI_Op Op;
+        MPI_Op_create(&state_op<T>, 1, &Op);
+
+        MPI_Allreduce(MPI_IN_PLACE, &t, 1, Type, Op, Comm);
+
+        MPI_Op_free(&Op);
+        MPI_Type_free(&Type);
+    } // allreduce
+
+    // non-blocking variant of allreduce, the result is in out once req completes,
+    // and in must not change until then
+    template <typename T> void iallreduce(const T& in, T& out, MPI_Comm Comm, MPI_Request* req) {
+        static_assert(archive::is_bitwise_v<T>, "iallreduce requires trivially copyable type");
+
+        MPI_Datatype Type;
+        MPI_Type_contiguous(sizeof(T), MPI_BYTE, &Type);
+        MPI_Type_commit(&Type);
+
+        MPI_Op Op;
+        MPI_Op_create(&state_op<T>, 1, &Op);
+
+        MPI_Iallreduce(&in, &out, 1, Type, Op, Comm, req);
+
+        // both are only marked for deallocation, and remain valid for the pending operation
+        MPI_Op_free(&Op);
+        MPI_Type_free(&Type);
+    } // iallreduce
+
     template <typename T> void broadcast(T& t, MPI_Comm Comm) {
         int size, rank;
 
@@ -176,9 +479,8 @@ namespace scool {
         int buf = 0;
 
         if (rank == 0) {
-            scool::util::fast_vector_obuf<char> ob(data);
-            std::ostream os(&ob);
-            os << t;
+            archive::writer ar(data);
+            archive::save(ar, t);
 
             buf = data.size();
 
@@ -191,9 +493,48 @@ namespace scool {
 
             MPI_Bcast(data.data(), buf, MPI_CHAR, 0, Comm);
 
-            scool::util::fast_vector_ibuf<char> ib(data);
-            std::istream is(&ib);
-            is >> t;
+            archive::reader ar(data);
+            archive::load(ar, t);
+        }
+    } // broadcast
+
+    // broadcasts t from rank 0, where prev is the value all ranks already hold,
+    // if t on rank 0 equals prev the payload is not sent and all ranks take prev
+    template <typename T> void broadcast(T& t, const T& prev, MPI_Comm Comm) {
+        if constexpr (!std::equality_comparable<T>) broadcast(t, Comm);
+        else {
+            int size, rank;
+
+            MPI_Comm_size(Comm, &size);
+            MPI_Comm_rank(Comm, &rank);
+
+            if (size < 2) return;
+
+            std::vector<char> data;
+            int buf = -1;
+
+            if (rank == 0) {
+                if (!(t == prev)) {
+                    archive::writer ar(data);
+                    archive::save(ar, t);
+                    buf = data.size();
+                }
+            }
+
+            MPI_Bcast(&buf, 1, MPI_INT, 0, Comm);
+
+            if (buf < 0) {
+                t = prev;
+                return;
+            }
+
+            data.resize(buf);
+            MPI_Bcast(data.data(), buf, MPI_CHAR, 0, Comm);
+
+            if (rank != 0) {
+                archive::reader ar(data);
+                archive::load(ar, t);
+            }
         }
     } // broadcast
 
@@ -0,0 +1,932 @@
+/***
+ *  $Id$
+ **
+ *  File: mpi_omp_executor.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef MPI_OMP_EXECUTOR_HPP
+#define MPI_OMP_EXECUTOR_HPP
+
+#include <numeric>
+
+#include "mpi_executor.hpp"
+#include "omp_impl.hpp"
+
+
+namespace scool {
+
+  template <typename ExecutorType, bool Unique = true>
+  class mpi_omp_context {
+  public:
+      using task_type = typename ExecutorType::task_type;
+
+      explicit mpi_omp_context(ExecutorType& exec) : exec_(exec) { }
+
+      int iteration() const { return exec_.iteration(); }
+
+      // this will be always called from parallel region
+      void push(const task_type& t) {
+          int tid = omp_get_thread_num();
+          exec_.pushed_[tid].n++;
+
+          if constexpr (Unique) {
+              if (!exec_.m_dive__(t, tid)) exec_.next_[tid].push_back(t);
+          } else {
+              auto pos = exec_.pt_(t) % static_cast<std::size_t>(exec_.nparts_);
+              exec_.next_mtx_[pos].lock();
+              impl::add_to<Unique>(exec_.next_[pos], t);
+              exec_.next_mtx_[pos].unlock();
+          }
+      } // push
+
+  private:
+      mpi_omp_context(const mpi_omp_context&) = delete;
+      void operator=(const mpi_omp_context&) = delete;
+
+      ExecutorType& exec_;
+
+  }; // class mpi_omp_context
+
+
+  // Class: mpi_omp_executor_base__
+  // Base class to derive <mpi_omp_executor>.
+  // Do not use directly!
+  template <typename TaskType, typename StateType, typename Partitioner>
+  class mpi_omp_executor_base__ : public mpi_executor_base__<TaskType, StateType, Partitioner> {
+  public:
+      using task_type = TaskType;
+      using state_type = StateType;
+      using partitioner = Partitioner;
+
+      explicit mpi_omp_executor_base__(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1,
+                                       const mpi_config& cfg = mpi_config())
+          : mpi_executor_base__<TaskType, StateType, Partitioner>(Comm, seed, cfg),
+            nthreads_(m_num_threads__()), sts_(nthreads_), pushed_(nthreads_) { }
+
+
+  protected:
+      static int m_num_threads__() {
+          int p = 1;
+
+          #pragma omp parallel
+          #pragma omp single
+          p = omp_get_num_threads();
+
+          return p;
+      } // m_num_threads__
+
+      // merges thread local states into gst_
+      // the incumbent channel is updated only here
+      void m_reduce_state__() {
+          SCOOL_TRACE_SCOPE("reduce_threads");
+          this->rdc_mtx_.lock();
+
+          for (auto& st : sts_) this->gst_ += st;
+          this->gst_.identity();
+          this->m_sync_bound__(this->gst_);
+          for (auto& st : sts_) st = this->gst_;
+
+          this->rdc_mtx_.unlock();
+      } // m_reduce_state__
+
+      void m_set_state__(const state_type& st) {
+          for (auto& x : sts_) x = st;
+      } // m_set_state__
+
+      void m_report__(long long int global_tasks) {
+          double mean = (double) global_tasks / this->size_;
+
+          float sd = std::sqrt(this->gcount_[3] / this->size_);
+          float p_sd = (sd / mean) * 100;
+
+          long long int processed_task =  this->gcount_[1] + this->gcount_[2];
+          if (processed_task != global_tasks) {
+              this->log().error() << "something went very wrong, task numbers mismatch!" << std::endl;
+          }
+
+          this->log().debug(this->NAME_) << "local tasks: " << this->gcount_[1]
+                                         << ", remote tasks: " << this->gcount_[2]
+                                         << ", standard deviation: "<< std::setprecision(3) << p_sd << "%"
+                                         << std::endl;
+      } // m_report__
+
+      // threads per rank
+      int nthreads_ = 1;
+
+      // thread local states
+      std::vector<state_type> sts_;
+
+      // calls to push per thread
+      std::vector<impl::thread_counter> pushed_;
+
+  }; // class mpi_omp_executor_base__
+
+
+  // General mpi_omp_executor (default choice)
+
+  // Class: mpi_omp_executor
+  // Hybrid <Executor> model built on top of Message Passing Interface and OpenMP.
+  // Each MPI rank runs a team of OMP threads that process its local tasks, while
+  // work stealing and reduction between ranks are handled as in <mpi_executor>.
+  // Running one rank per node keeps a single copy of read-only problem data per node.
+  // The number of threads per rank is controlled via standard OMP environment variables.
+  // Requires MPI_THREAD_MULTIPLE, or MPI_THREAD_FUNNELED with <mpi_config::progress> set to POLLING.
+  //
+  // Parameters:
+  // Unique - if *true*, the search space is assumed to be a tree (i.e., tasks are unique), otherwise it is a graph.
+  template <typename TaskType, typename StateType, typename Partitioner = simple_partitioner<TaskType>, bool Unique = false>
+  class mpi_omp_executor : public mpi_omp_executor_base__<TaskType, StateType, Partitioner> {
+  public:
+      // Type: task_type
+      // Alias to the user provided *TaskType* type representing a task.
+      using task_type = TaskType;
+
+      // Type: state_type
+      // Alias to the user provided *StateType* type representing a global shared state.
+      using state_type = StateType;
+
+      // Type: partitioner
+      // Alias to user provided *Partitioner* type representing a task partitioner.
+      using partitioner = Partitioner;
+
+
+      // Function: mpi_omp_executor
+      // Creates and launches mpi_omp_executor runtime.
+      //
+      // Parameters:
+      //   Comm - MPI communicator to that the executor should use for communication.
+      //   seed - random number generator seed, see <mpi_executor>.
+      //   cfg  - runtime configuration, see <mpi_config>.
+      explicit mpi_omp_executor(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1, const mpi_config& cfg = mpi_config())
+          : mpi_omp_executor_base__<TaskType, StateType, Partitioner>(Comm, seed, cfg), ctx_(*this),
+            nparts_(this->size_ * this->nthreads_), curr_mtx_(nparts_), next_mtx_(nparts_),
+            curr_(nparts_), curr_head_(nparts_, 0), next_(nparts_), porder_(nparts_) {
+          MPI_Comm_dup(this->Comm_, &this->Comm_hlp_);
+          this->m_start_listener__();
+
+          MPI_Barrier(this->Comm_);
+
+          this->log().info(this->NAME_) << "ready with " << this->size_ << " ranks, "
+                                        << this->nthreads_ << " threads each" << std::endl;
+      } // mpi_omp_executor
+
+
+      void init(const task_type& t, const state_type& st, const partitioner& pt = partitioner()) {
+          std::vector<task_type> v{t};
+          init(std::begin(v), std::end(v), st, pt);
+      } // init
+
+      // Function: init
+      template <typename Iter>
+      void init(Iter first, Iter last, const state_type& st, const partitioner& pt = partitioner()) {
+          pt_ = pt;
+
+          // rank owns partitions [rank * nthreads_, (rank + 1) * nthreads_)
+          for (; first != last; ++first) {
+              auto pos = pt_(*first) % static_cast<std::size_t>(nparts_);
+              if (pos / this->nthreads_ == static_cast<std::size_t>(this->rank_)) impl::add_to<Unique>(next_[pos], *first);
+          }
+
+          long long int count = m_swap_queues__();
+
+          this->gst_ = st;
+          this->pst_ = st;
+          this->lst_ = st;
+          this->rst_ = st;
+          this->m_set_state__(st);
+
+          MPI_Allreduce(&count, &this->gcount_[0], 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+
+          MPI_Barrier(this->Comm_);
+      } // init
+
+      // Function: restart
+      // Initializes executor from checkpoint *name* written by any executor,
+      // possibly with a different number of ranks. Use instead of <init>.
+      //
+      // Returns:
+      //   false if *name* is not a valid checkpoint.
+      bool restart(const std::string& name, const partitioner& pt = partitioner()) {
+          pt_ = pt;
+
+          long long int count = this->m_read_checkpoint__(name, [this](task_type&& t) {
+              auto pos = pt_(t) % static_cast<std::size_t>(nparts_);
+              impl::add_to<Unique>(next_[pos], t);
+          });
+
+          if (count < 0) return false;
+
+          // blocks do not have to match owners
+          if (this->size_ > 1) m_exchange_queues__();
+
+          count = m_swap_queues__();
+
+          this->pst_ = this->gst_;
+          this->lst_ = this->gst_;
+          this->rst_ = this->gst_;
+          this->m_set_state__(this->gst_);
+
+          MPI_Allreduce(&count, &this->gcount_[0], 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+
+          MPI_Barrier(this->Comm_);
+
+          return true;
+      } // restart
+
+
+      // Function: step
+      long long int step() {
+          this->log().info(this->NAME_) << "processing " << this->gcount_[0]
+                                        << " tasks, superstep " << this->giter_
+                                        << "..." << std::endl;
+
+          long long int global_tasks  = this->gcount_[0];
+          long long int count[4] = {0, 0, 0, 0};
+
+          this->m_begin_metrics__();
+
+          this->passive_.clear();
+          this->lst_ = this->gst_;
+          this->rst_ = this->gst_;
+
+          // process local queue
+          auto t0 = std::chrono::steady_clock::now();
+          count[1] = m_process_local_queue__();
+          this->mx_.time_process = this->m_elapsed__(t0);
+
+          // go into stealing mode
+          t0 = std::chrono::steady_clock::now();
+
+          {
+              SCOOL_PERF_TEAM_SCOPE(this->mx_.hw_steal);
+
+              count[2] = this->m_steal_tasks__(this->Comm_hlp_, [this](std::vector<task_type>& T) {
+                  m_process_batch__(T);
+              });
+          }
+
+          this->mx_.time_steal = this->m_elapsed__(t0);
+
+          // route new tasks to owners
+          long long int received = 0;
+
+          if (this->cfg_.exchange_tasks) {
+              t0 = std::chrono::steady_clock::now();
+              received = m_exchange_queues__();
+              this->mx_.time_exchange = this->m_elapsed__(t0);
+          }
+
+          // update size
+          count[0] = 0;
+          for (auto& x : next_) count[0] += x.size();
+
+          // calculate standard deviation
+          long long int local_task = count[1] + count[2];
+
+          double mean = (double) global_tasks / this->size_;
+          double local_sq_diff = (local_task - mean) * (local_task - mean);
+
+          count[3] = std::llround(local_sq_diff);
+
+          // take care of global state
+          this->m_reduce_counts__(count, this->gcount_, 4);
+
+          this->m_report__(global_tasks);
+
+          // get local queues in proper shape
+          // at this stage all ranks are in sync
+          this->tokens_.reset();
+          m_swap_queues__();
+
+          this->m_sync_state__(true);
+
+          this->m_set_state__(this->gst_);
+
+          this->giter_++;
+
+          this->m_tick_checkpoint__([this](archive::writer& ar) {
+              for (auto& Q : curr_) impl::save_frames(ar, std::begin(Q), std::end(Q));
+          });
+
+          auto& mx = this->mx_;
+
+          mx.tasks_processed = local_task;
+          mx.tasks_pushed = impl::collect(this->pushed_);
+          mx.frontier_tasks = count[0];
+          mx.frontier_bytes = count[0] * sizeof(task_type);
+          mx.tasks_merged = mx.tasks_pushed - mx.tasks_exchanged + received - count[0];
+
+          this->m_end_metrics__();
+
+          return this->gcount_[0];
+      } // step
+
+
+  private:
+      using local_storage_type = std::vector<phmap::node_hash_set<task_type>>;
+
+      friend mpi_omp_context<mpi_omp_executor, Unique>;
+      mpi_omp_context<mpi_omp_executor, Unique> ctx_;
+
+      using typename mpi_executor_base__<TaskType, StateType, Partitioner>::req_data_type;
+
+      // this runs in listener thread, or in master thread when polling
+      void m_serve_request__(req_data_type req, int target, MPI_Comm Comm) override {
+          const int NUM_TRY = 3;
+
+          if (req == this->REQ_RDC) {
+              // states are reduced at the end of superstep
+              // here we only make sure the message is consumed
+              state_type tmp_st = this->rst_;
+              mpi_impl::receive_and_deserialize(tmp_st, target, this->RDC_TAG, Comm);
+              this->rdc_mtx_.lock();
+              this->rst_ += tmp_st;
+              this->rdc_mtx_.unlock();
+              return;
+          }
+
+          if (req != this->REQ_ASK) return;
+
+          std::vector<task_type> T;
+          int sz = curr_size_.load();
+
+          if (sz > 0) {
+              // we give away a fraction of what is left
+              int want = std::ceil(this->cfg_.steal_fraction * sz);
+              if (this->cfg_.steal_max_tasks > 0) want = std::min(want, this->cfg_.steal_max_tasks);
+
+              if (this->cfg_.exchange_tasks) {
+                  // once tasks are routed to owners, all work sits in partitions of this rank,
+                  // so the slice is combined from their tails
+                  int off = this->rng1_() % this->nthreads_;
+
+                  for (int i = 0; (i < this->nthreads_) && (static_cast<int>(T.size()) < want); ++i) {
+                      int pos = this->rank_ * this->nthreads_ + (off + i) % this->nthreads_;
+                      std::lock_guard<std::mutex> lock(curr_mtx_[pos]);
+                      m_extract_tail__(pos, want - static_cast<int>(T.size()), T);
+                  }
+              } else {
+                  // otherwise let's try several partitions, and combine slices from them
+                  // first attempt is always work owned by the thief
+                  auto step = this->rng1_() % nparts_;
+                  int start = target * this->nthreads_ + (this->rng1_() % this->nthreads_);
+
+                  for (int i = 0; (i < NUM_TRY) && (static_cast<int>(T.size()) < want); ++i) {
+                      int pos = (start + i * step) % nparts_;
+
+                      if (curr_mtx_[pos].try_lock()) {
+                          m_extract_tail__(pos, want - static_cast<int>(T.size()), T);
+                          curr_mtx_[pos].unlock();
+                      }
+                  } // for i
+              }
+          } // if sz
+
+          // tasks are already out of the queue, so we serialize without locks
+          if (T.empty()) this->m_send_message_head__(this->REQ_NONE, target, this->ANS_TAG, Comm);
+          else this->m_send_answer__(T.begin(), T.end(), target, Comm);
+      } // m_serve_request__
+
+      // moves up to n tasks from the tail of partition pos to T
+      // the caller must hold curr_mtx_[pos]
+      void m_extract_tail__(int pos, int n, std::vector<task_type>& T) {
+          auto& Q = curr_[pos];
+
+          int avail = Q.size() - curr_head_[pos];
+          if (avail <= 0) return;
+
+          // no more than a fraction of the partition
+          n = std::min<int>({n, avail, static_cast<int>(std::ceil(this->cfg_.steal_fraction * avail))});
+
+          auto first = std::end(Q) - n;
+          std::move(first, std::end(Q), std::back_inserter(T));
+
+          // this never reallocates, so chunks claimed by workers remain valid
+          Q.erase(first, std::end(Q));
+          curr_size_.fetch_sub(n);
+      } // m_extract_tail__
+
+      int m_process_local_queue__() {
+          SCOOL_TRACE_SCOPE("process_local_queue");
+          SCOOL_PERF_TEAM_SCOPE(this->mx_.hw_process);
+
+          int count = 0;
+
+          // owned partitions go first, the rest in random order
+          std::iota(std::begin(porder_), std::end(porder_), 0);
+          std::shuffle(std::begin(porder_), std::end(porder_), this->rng0_);
+
+          for (int i = 0; i < this->nthreads_; ++i) {
+              auto pos = std::find(std::begin(porder_), std::end(porder_), this->rank_ * this->nthreads_ + i);
+              std::swap(porder_[i], *pos);
+          }
+
+          state_type* sts = this->sts_.data();
+
+          #pragma omp parallel for schedule(dynamic, 1) reduction(+:count)
+          for (int i = 0; i < nparts_; ++i) {
+              int tid = omp_get_thread_num();
+              auto pos = porder_[i];
+
+              // tasks are claimed from the head of partition in chunks,
+              // such that the listener can give away the rest of partition in the meantime
+              do {
+                  curr_mtx_[pos].lock();
+
+                  int first = curr_head_[pos];
+                  int last = std::min<int>(first + PROCESS_CHUNK, curr_[pos].size());
+
+                  curr_head_[pos] = last;
+                  curr_size_.fetch_sub(last - first);
+
+                  curr_mtx_[pos].unlock();
+
+                  if (first == last) break;
+
+                  // in POLLING mode master thread serves requests, but never while holding partition
+                  for (; first < last; ++first, ++count) {
+                      curr_[pos][first].process(ctx_, sts[tid]);
+                      if (tid == 0) this->m_tick_progress__();
+                  }
+              } while (true);
+          } // for i
+
+          this->m_reduce_state__();
+
+          return count;
+      } // m_process_local_queue__
+
+      void m_process_batch__(std::vector<task_type>& T) {
+          SCOOL_TRACE_SCOPE("process_batch");
+
+          int n = T.size();
+          state_type* sts = this->sts_.data();
+
+          #pragma omp parallel for schedule(dynamic, 1)
+          for (int i = 0; i < n; ++i) {
+              int tid = omp_get_thread_num();
+              T[i].process(ctx_, sts[tid]);
+              if (tid == 0) this->m_tick_progress__();
+          }
+
+          this->m_reduce_state__();
+      } // m_process_batch__
+
+      // moves new tasks to processing queue, each partition ordered by priority from both ends
+      long long int m_swap_queues__() {
+          long long int count = 0;
+
+          #pragma omp parallel for schedule(dynamic, 1) reduction(+:count)
+          for (int i = 0; i < nparts_; ++i) {
+              curr_[i].clear();
+              curr_[i].reserve(next_[i].size());
+
+              while (!next_[i].empty()) {
+                  auto node = next_[i].extract(next_[i].begin());
+                  curr_[i].push_back(std::move(node.value()));
+              }
+
+              // workers claim from the head, thieves take the tail, both start with the best tasks
+              impl::sort_by_priority_two_ends(curr_[i]);
+
+              curr_head_[i] = 0;
+              count += curr_[i].size();
+          }
+
+          curr_size_ = count;
+          return count;
+      } // m_swap_queues__
+
+      // sends tasks to their owners, duplicates are merged on arrival
+      // returns the number of received tasks
+      long long int m_exchange_queues__() {
+          SCOOL_TRACE_SCOPE("exchange");
+          SCOOL_PERF_SCOPE(this->mx_.hw_merge);
+
+          this->log().debug(this->NAME_) << "exchanging queues..." << std::endl;
+
+          std::vector<char> data;
+          archive::writer ar(data);
+
+          std::vector<std::vector<std::size_t>> bounds(this->size_);
+
+          for (int i = 0; i < this->size_; ++i) {
+              bounds[i].push_back(data.size());
+              if (i == this->rank_) continue;
+
+              for (int pos = i * this->nthreads_; pos < (i + 1) * this->nthreads_; ++pos) {
+                  mpi_impl::serialize_frames(ar, next_[pos].begin(), next_[pos].end(), EXCHANGE_FRAME, bounds[i]);
+                  this->mx_.tasks_exchanged += next_[pos].size();
+                  next_[pos].clear();
+              }
+          } // for i
+
+          long long int n = 0;
+
+          mpi_impl::alltoall_frames(data, bounds, this->cfg_.exchange_round_size, this->Comm_, [this, &n](std::vector<char>& buf) {
+              archive::reader ar(buf);
+
+              while (!ar.empty()) {
+                  archive::for_each<task_type>(ar, [this, &n](task_type&& t) {
+                      auto pos = pt_(t) % static_cast<std::size_t>(nparts_);
+                      impl::add_to<Unique>(next_[pos], t);
+                      ++n;
+                  });
+              }
+          });
+
+          return n;
+      } // m_exchange_queues__
+
+      // partitions, each rank owns nthreads_ of them
+      int nparts_;
+
+      std::atomic_int_fast32_t curr_size_;
+      std::vector<std::mutex> curr_mtx_;
+      std::vector<std::mutex> next_mtx_;
+
+      // partitions of the current superstep are ordered by priority from both ends,
+      // and processed from curr_head_
+      std::vector<std::vector<task_type>> curr_;
+      std::vector<int> curr_head_;
+
+      local_storage_type next_;
+
+      std::vector<int> porder_;
+      Partitioner pt_;
+
+      // the number of tasks in a single exchange frame
+      static const int EXCHANGE_FRAME = 1024;
+
+      // the number of tasks claimed per lock in local processing
+      static const int PROCESS_CHUNK = 16;
+
+  }; // class mpi_omp_executor
+
+
+  // specialized mpi_omp_executor for cases where tasks are guaranteed to be unique
+
+  // Class: mpi_omp_executor
+  // This is template specialization for when the search space is assumed to be a tree,
+  // (i.e., tasks are guaranteed to be unique).
+  template <typename TaskType, typename StateType, typename Partitioner>
+  class mpi_omp_executor<TaskType, StateType, Partitioner, true>
+      : public mpi_omp_executor_base__<TaskType, StateType, Partitioner> {
+  public:
+      using task_type = TaskType;
+      using state_type = StateType;
+      using partitioner = Partitioner;
+
+
+      explicit mpi_omp_executor(MPI_Comm Comm = MPI_COMM_WORLD, int seed = -1, const mpi_config& cfg = mpi_config())
+          : mpi_omp_executor_base__<TaskType, StateType, Partitioner>(Comm, seed, cfg), ctx_(*this),
+            next_(this->nthreads_), dfs_(this->nthreads_) {
+          MPI_Comm_dup(this->Comm_, &this->Comm_hlp_);
+          this->m_start_listener__();
+
+          MPI_Barrier(this->Comm_);
+
+          this->log().info(this->NAME_) << "ready with " << this->size_ << " ranks, "
+                                        << this->nthreads_ << " threads each" << std::endl;
+      } // mpi_omp_executor
+
+
+      void init(const task_type& t, const state_type& st,
+                const partitioner& pt = partitioner()) {
+          std::vector<task_type> v{t};
+          init(std::begin(v), std::end(v), st, pt);
+      } // init
+
+      // Function: init
+      // Rank 0 scatters [first, last) across ranks, see <mpi_executor::init>.
+      template <typename Iter>
+      void init(Iter first, Iter last, const state_type& st,
+                const partitioner& pt = partitioner()) {
+          long long int n = this->m_scatter_tasks__(first, last, pt, curr_);
+          m_init__(n, st);
+      } // init
+
+      // Function: init_local
+      // Every rank supplies its own slice [first, last) of initial tasks.
+      template <typename Iter>
+      void init_local(Iter first, Iter last, const state_type& st) {
+          for (; first != last; ++first) impl::add_to<true>(curr_, *first);
+          long long int count = curr_.size();
+          long long int n = 0;
+          MPI_Allreduce(&count, &n, 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+          m_init__(n, st);
+      } // init_local
+
+      // Function: depth_first
+      // Lets ctx.push() process a new task in place, depth first, as long as the recursion
+      // in a thread is at most *depth* levels deep, see <mpi_executor::depth_first>.
+      void depth_first(int depth) { for (auto& b : dfs_) b.limit(depth); }
+
+      // Function: restart
+      // Initializes executor from checkpoint *name* written by any executor,
+      // possibly with a different number of ranks. Use instead of <init>.
+      //
+      // Returns:
+      //   false if *name* is not a valid checkpoint.
+      bool restart(const std::string& name, const partitioner& /* pt */ = partitioner()) {
+          // blocks are spread round robin, and the partitioner is not needed
+          long long int count = this->m_read_checkpoint__(name, [this](task_type&& t) { curr_.push_back(std::move(t)); });
+          if (count < 0) return false;
+
+          long long int n = 0;
+          MPI_Allreduce(&count, &n, 1, MPI_LONG_LONG_INT, MPI_SUM, this->Comm_);
+
+          m_init__(n, this->gst_);
+
+          return true;
+      } // restart
+
+
+      long long int step() {
+          this->log().info(this->NAME_) << "processing " << this->gcount_[0]
+                                        << " tasks, superstep " << this->giter_
+                                        << "..." << std::endl;
+
+          long long int global_tasks  = this->gcount_[0];
+          long long int count[4] = {0, 0, 0, 0};
+
+          this->m_begin_metrics__();
+          this->m_barrier__();
+
+          this->passive_.clear();
+          this->demand_.clear();
+          this->lst_ = this->gst_;
+          this->rst_ = this->gst_;
+
+          // process local queue
+          auto t0 = std::chrono::steady_clock::now();
+          count[1] = m_process_local_queue__();
+          this->mx_.time_process = this->m_elapsed__(t0);
+
+          this->task_time_ += this->mx_.time_process;
+          this->task_count_ += count[1];
+
+          // go into stealing mode
+          t0 = std::chrono::steady_clock::now();
+
+          {
+              SCOOL_PERF_TEAM_SCOPE(this->mx_.hw_steal);
+
+              count[2] = this->m_steal_tasks__(this->Comm_hlp_, [this](std::vector<task_type>& T) {
+                  m_process_batch__(T);
+              });
+          }
+
+          this->mx_.time_steal = this->m_elapsed__(t0);
+
+          for (auto& x : next_) count[0] += x.size();
+
+          // calculate standard deviation
+          long long int local_task = count[1] + count[2];
+
+          double mean = (double) global_tasks / this->size_;
+          double local_sq_diff = (local_task - mean) * (local_task - mean);
+
+          count[3] = std::llround(local_sq_diff);
+
+          this->m_barrier__();
+
+          this->m_reduce_counts__(count, this->gcount_, 4);
+
+          // get local queues in proper shape
+          this->tokens_.reset();
+
+          curr_.clear();
+          curr_.reserve(count[0]);
+
+          for (auto& x : next_) {
+              curr_.insert(std::end(curr_), std::make_move_iterator(std::begin(x)), std::make_move_iterator(std::end(x)));
+              x.clear();
+          }
+
+          // the best tasks go first to owner and to thieves
+          impl::sort_by_priority_two_ends(curr_);
+
+          // threads claim from the shared part of queue concurrently
+          this->m_set_granularity__(mtx_, curr_.size(), this->nthreads_);
+
+          hlp_pos_ = curr_.size();
+          curr_pos_ = 0;
+          goal_post_ = std::ceil(this->local_queue_size_ * curr_.size());
+
+          this->m_report__(global_tasks);
+
+          this->m_barrier__();
+          // without listener, state is reduced collectively
+          this->m_sync_state__(!this->hlp_th_.joinable());
+
+          this->m_set_state__(this->gst_);
+
+          this->giter_++;
+
+          this->m_tick_checkpoint__([this](archive::writer& ar) { impl::save_frames(ar, std::begin(curr_), std::end(curr_)); });
+
+          this->mx_.tasks_processed = local_task;
+          this->mx_.tasks_pushed = impl::collect(this->pushed_);
+          this->mx_.frontier_tasks = count[0];
+          this->mx_.frontier_bytes = count[0] * sizeof(task_type);
+
+          this->m_end_metrics__();
+
+          return this->gcount_[0];
+      } // step
+
+
+  private:
+      using local_storage_type = std::vector<task_type>;
+
+      friend mpi_omp_context<mpi_omp_executor, true>;
+      mpi_omp_context<mpi_omp_executor, true> ctx_;
+
+
+      using typename mpi_executor_base__<TaskType, StateType, Partitioner>::req_data_type;
+
+      // sets up the first superstep once curr_ holds local tasks, n is the global count
+      void m_init__(long long int n, const state_type& st) {
+          this->gcount_[0] = n;
+          this->gcount_[1] = this->gcount_[2] = this->gcount_[3] = 0;
+
+          this->gst_ = st;
+          this->pst_ = st;
+          this->lst_ = st;
+          this->rst_ = st;
+          this->m_set_state__(st);
+
+          impl::sort_by_priority_two_ends(curr_);
+
+          hlp_pos_ = curr_.size();
+          curr_pos_ = 0;
+
+          goal_post_ = std::ceil(this->local_queue_size_ * curr_.size());
+
+          // to avoid data race between early stealing threads
+          MPI_Barrier(this->Comm_);
+      } // m_init__
+
+      // this runs in listener thread, or in master thread when polling
+      void m_serve_request__(req_data_type req, int target, MPI_Comm Comm) override {
+          if (req == this->REQ_RDC) {
+              state_type tmp_st = this->rst_;
+              mpi_impl::receive_and_deserialize(tmp_st, target, this->RDC_TAG, Comm);
+              this->rdc_mtx_.lock();
+              this->rst_ += tmp_st;
+              this->rdc_mtx_.unlock();
+
+              if (this->passive_.test()) {
+                  if (this->rank_ != 0) this->gst_.identity();
+                  this->m_reduce_and_forward__(Comm);
+              }
+              return;
+          }
+
+          if (req == this->REQ_ASK) {
+              int start, end, batch, count;
+
+              // calculating the batch size based on active ranks and the cost model
+              count = this->size_ - this->tokens_.count();
+
+              mtx_.lock();
+              batch = std::ceil((hlp_pos_ - goal_post_) * this->m_steal_fraction__(hlp_pos_ - goal_post_, count));
+              batch = std::max(batch, this->min_steal_batch_);
+              start = hlp_pos_ - batch;
+
+              if ((start <= goal_post_) || ((start - curr_pos_) < this->task_chunk_)) {
+                  mtx_.unlock();
+                  this->demand_.test_and_set();
+                  this->m_send_message_head__(this->REQ_NONE, target, this->ANS_TAG, Comm);
+                  return;
+              }
+
+              end = hlp_pos_;
+              hlp_pos_ = start;
+
+              mtx_.unlock();
+
+              auto first = std::next(curr_.begin(), hlp_pos_);
+              auto last = std::next(curr_.begin(), end);
+
+              this->m_send_answer__(first, last, target, Comm);
+          } // if req == REQ_ASK
+      } // m_serve_request__
+
+
+      // this runs in main thread
+      int m_process_local_queue__() {
+          SCOOL_TRACE_SCOPE("process_local_queue");
+          SCOOL_PERF_TEAM_SCOPE(this->mx_.hw_process);
+
+          int S = 0;
+          int local_end = goal_post_;
+          int chunk = this->task_chunk_;
+
+          // local portion of the queue is never stolen
+          mtx_.lock();
+          curr_pos_ = goal_post_;
+          mtx_.unlock();
+
+          state_type* sts = this->sts_.data();
+
+          #pragma omp parallel reduction(+:S)
+          {
+              int tid = omp_get_thread_num();
+
+              // 1. process local portion of the queue
+              #pragma omp for schedule(dynamic, chunk) nowait
+              for (int i = 0; i < local_end; ++i) {
+                  curr_[i].process(ctx_, sts[tid]);
+                  if (tid == 0) this->m_tick_progress__();
+                  S++;
+              }
+
+              // 2. process shared portion of the queue
+              int pos = 0;
+              int last = 0;
+
+              while (true) {
+                  mtx_.lock();
+                  if (curr_pos_ == hlp_pos_) {
+                      mtx_.unlock();
+                      break;
+                  }
+
+                  pos = curr_pos_;
+                  curr_pos_ = std::min(curr_pos_ + chunk, hlp_pos_);
+                  last = curr_pos_;
+
+                  mtx_.unlock();
+
+                  for (; pos < last; ++pos, ++S) {
+                      curr_[pos].process(ctx_, sts[tid]);
+                      if (tid == 0) this->m_tick_progress__();
+                  }
+              }
+          } // omp parallel
+
+          this->m_reduce_state__();
+
+          return S;
+      } // m_process_local_queue__
+
+      // processes t in place in thread tid, if its depth-first budget allows
+      bool m_dive__(const task_type& t, int tid) {
+          if (this->demand_.test() || !dfs_[tid].enter()) return false;
+
+          task_type x = t;
+          x.process(ctx_, this->sts_[tid]);
+          if (tid == 0) this->m_tick_progress__();
+
+          dfs_[tid].leave();
+          return true;
+      } // m_dive__
+
+      void m_process_batch__(std::vector<task_type>& T) {
+          SCOOL_TRACE_SCOPE("process_batch");
+
+          int n = T.size();
+          state_type* sts = this->sts_.data();
+
+          impl::sort_by_priority(std::begin(T), std::end(T));
+
+          #pragma omp parallel for schedule(dynamic, 1)
+          for (int i = 0; i < n; ++i) {
+              int tid = omp_get_thread_num();
+              T[i].process(ctx_, sts[tid]);
+              if (tid == 0) this->m_tick_progress__();
+          }
+
+          this->m_reduce_state__();
+      } // m_process_batch__
+
+
+      // queue indexes
+      int goal_post_ = 0;
+      int curr_pos_ = 0;
+      int hlp_pos_ = 0;
+
+      std::mutex mtx_;
+
+      // work queues, next_ is per thread
+      local_storage_type curr_;
+      std::vector<local_storage_type> next_;
+
+      // per-thread depth-first budgets
+      std::vector<impl::dfs_budget> dfs_;
+
+  }; // class mpi_omp_executor
+
+} // namespace scool
+
+#endif // MPI_OMP_EXECUTOR_HPP
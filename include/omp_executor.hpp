@@ -15,12 +15,19 @@
 #ifndef OMP_EXECUTOR_HPP
 #define OMP_EXECUTOR_HPP
 
+#include <chrono>
+#include <functional>
 #include <numeric>
+#include <string>
 #include <omp.h>
 
+#include "checkpoint.hpp"
 #include "impl.hpp"
+#include "metrics.hpp"
 #include "omp_impl.hpp"
 #include "partitioner.hpp"
+#include "perf_counters.hpp"
+#include "trace.hpp"
 
 #include "jaz/logger.hpp"
 #include "omp_process_table.hpp"
@@ -44,10 +51,13 @@ namespace scool {
       // this will be always called from parallel region
       void push(const task_type& t) {
           int tid = omp_get_thread_num();
+          exec_.pushed_[tid].n++;
+
           if constexpr (!Unique) {
               exec_.next_.insert(t);
            }
            else{
+              if (exec_.m_dive__(t, tid)) return;
               impl::add_to<Unique>(exec_.next_[tid], t);
            }
           
@@ -75,6 +85,8 @@ namespace scool {
 
       omp_executor_base__() = default;
 
+      ~omp_executor_base__() { SCOOL_TRACE_WRITE(); }
+
 
       // Function: log
       jaz::Logger& log() { return log_; }
@@ -85,8 +97,68 @@ namespace scool {
       // Function: state
       const state_type& state() { return gst_; }
 
+      // Function: checkpoint
+      // Enables checkpointing: every *interval* supersteps the current frontier,
+      // the global state and the iteration counter are written to file *name*.
+      // The file is replaced only once it has been completely written.
+      void checkpoint(const std::string& name, int interval) {
+          ckpt_name_ = name;
+          ckpt_interval_ = interval;
+      } // checkpoint
+
+      // Function: on_metrics
+      // Sets function called with <metrics> at the end of each superstep.
+      void on_metrics(std::function<void(const metrics&)> f) { sink_.callback(std::move(f)); }
+
+      // Function: metrics_file
+      // Writes <metrics> of each superstep to file *name*, as JSON Lines.
+      //
+      // Returns:
+      //   false if *name* could not be opened.
+      bool metrics_file(const std::string& name) { return sink_.open(name); }
+
 
   protected:
+      static double m_elapsed__(std::chrono::steady_clock::time_point t0) {
+          return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      } // m_elapsed__
+
+      // completes metrics of superstep that started at t0, and passes them on
+      void m_report_metrics__(std::chrono::steady_clock::time_point t0) {
+          mx_.iteration = iter_ - 1;
+          mx_.tasks_pushed += impl::collect(pushed_);
+          mx_.time_total = m_elapsed__(t0);
+
+          sink_.call(mx_);
+          if (sink_.is_open()) sink_.write(mx_);
+
+          mx_ = metrics{};
+      } // m_report_metrics__
+
+      // writes checkpoint if it is due, fill(archive::writer&) serializes the frontier
+      template <typename Fun>
+      void m_tick_checkpoint__(Fun fill) {
+          if ((ckpt_interval_ < 1) || (iter_ % ckpt_interval_ != 0)) return;
+          if (!impl::save_checkpoint(ckpt_name_, iter_, gst_, fill)) {
+              log().error(NAME_) << "could not write checkpoint " << ckpt_name_ << std::endl;
+          }
+      } // m_tick_checkpoint__
+
+      // reads checkpoint, add(task_type&&) stores a task in the frontier
+      template <typename Fun>
+      bool m_restart__(const std::string& name, Fun add) {
+          ntasks_ = impl::load_checkpoint<task_type>(name, iter_, gst_, add);
+          if (ntasks_ < 0) {
+              ntasks_ = 0;
+              return false;
+          }
+
+          for (auto& st : sts_) st = gst_;
+
+          log().info(NAME_) << "restarted " << ntasks_ << " tasks, superstep " << iter_ << std::endl;
+          return true;
+      } // m_restart__
+
       template <bool Unique, typename Iter, typename Store>
       void m_init__(Iter first, Iter last, Store& store, const state_type& st) {
           this->ntasks_ = 0;
@@ -105,6 +177,9 @@ namespace scool {
       } // m_process_group__
 
       void m_reduce_state__() {
+          SCOOL_TRACE_SCOPE("reduce");
+          SCOOL_PERF_SCOPE(mx_.hw_reduce);
+
           // here we go with the global state
           //log().debug(NAME_) << "reducing to global state..." << std::endl;
 
@@ -123,6 +198,15 @@ namespace scool {
       long long int ntasks_ = 0;
       int iter_ = 0;
 
+      std::string ckpt_name_;
+      int ckpt_interval_ = 0;
+
+      metrics mx_;
+      impl::metrics_sink sink_;
+
+      // calls to push per thread
+      std::vector<impl::thread_counter> pushed_;
+
   private:
       omp_executor_base__(const omp_executor_base__&) = delete;
       void operator=(const omp_executor_base__&) = delete;
@@ -166,6 +250,7 @@ namespace scool {
               p = omp_get_num_threads();
 
               this->sts_.resize(p);
+              this->pushed_.resize(p);
 
             //   B_ = 40009;
               B_ = 40009;
@@ -193,6 +278,17 @@ namespace scool {
             this->gst_ = st;
       } // init
 
+      // Function: restart
+      // Initializes executor from checkpoint *name* written by any executor.
+      // Use instead of <init>.
+      //
+      // Returns:
+      //   false if *name* is not a valid checkpoint.
+      bool restart(const std::string& name, const partitioner& /* pt */ = partitioner()) {
+          // the shared table hashes tasks itself, and the partitioner is not needed
+          return this->m_restart__(name, [this](task_type&& t) { next_.insert(t); });
+      } // restart
+
 
       // Function: step
       long long int step() {
@@ -201,38 +297,50 @@ namespace scool {
                                         << "..." << std::endl;
 
 
-          auto t4 = std::chrono::system_clock::now();
+          auto t4 = std::chrono::steady_clock::now();
           std::swap(curr_, next_);
 
           //next_.soft_clear();
           next_.lazy_clear();
 
-          auto t5 = std::chrono::system_clock::now();
-          auto elapsed_par_2 = std::chrono::duration<double>(t5 - t4);
-          this->log().info(this->NAME_) << "swap and clear took : " <<  elapsed_par_2.count() << std::endl;
+          this->log().info(this->NAME_) << "swap and clear took : " << this->m_elapsed__(t4) << std::endl;
 
           this->iter_++;
 
-          auto t0 = std::chrono::system_clock::now();
+          auto t0 = std::chrono::steady_clock::now();
           m_process__();
 
-          auto t1 = std::chrono::system_clock::now();
-          auto elapsed_par = std::chrono::duration<double>(t1 - t0);
-          this->log().info(this->NAME_) << "Processing took : " <<  elapsed_par.count() << std::endl;
-
+          this->mx_.time_process = this->m_elapsed__(t0);
+          this->log().info(this->NAME_) << "Processing took : " << this->mx_.time_process << std::endl;
 
+          auto t1 = std::chrono::steady_clock::now();
           this->m_reduce_state__();
+          this->mx_.time_reduce = this->m_elapsed__(t1);
+
+          auto t2 = std::chrono::steady_clock::now();
+
+          {
+              SCOOL_PERF_TEAM_SCOPE(this->mx_.hw_merge);
+              next_.reconcile();
+          }
 
-          auto t2 = std::chrono::system_clock::now();
-          next_.reconcile();
-          auto t3 = std::chrono::system_clock::now();
-          auto elapsed_par_1 = std::chrono::duration<double>(t3 - t2);
-          this->log().info(this->NAME_) << "Merging took : " <<  elapsed_par_1.count() << std::endl;
+          this->mx_.time_merge = this->m_elapsed__(t2);
+          this->log().info(this->NAME_) << "Merging took : " << this->mx_.time_merge << std::endl;
 
+          this->mx_.tasks_processed = this->ntasks_;
 
           this->ntasks_ = 0;
           this->ntasks_ += next_.master_view_size();
-          
+
+          this->m_tick_checkpoint__([this](archive::writer& ar) { impl::save_frames(ar, next_.begin(), next_.end()); });
+
+          this->mx_.frontier_tasks = this->ntasks_;
+          this->mx_.frontier_bytes = this->ntasks_ * sizeof(task_type);
+          this->mx_.tasks_pushed = impl::collect(this->pushed_);
+          this->mx_.tasks_merged = this->mx_.tasks_pushed - this->ntasks_;
+
+          this->m_report_metrics__(t4);
+
           return this->ntasks_;
       } // step
 
@@ -241,6 +349,9 @@ namespace scool {
       using local_storage_type = omp_process_table<task_type, std::hash<task_type>, std::allocator>;
 
       void m_process__() {
+            SCOOL_TRACE_SCOPE("process");
+            SCOOL_PERF_TEAM_SCOPE(this->mx_.hw_process);
+
             int p = curr_.num_views();
             state_type* sts = this->sts_.data();
             this->log().info(this->NAME_) << "Processing started..." << std::endl;
@@ -359,6 +470,8 @@ namespace scool {
                  #pragma omp task 
                  {
                      if(m_state[b]==true){
+                        // buckets are plain vectors, and can be ordered in place
+                        impl::sort_by_priority(std::begin(S_[b]), std::end(S_[b]));
                         for (auto t:S_[b]){
                         int tid = omp_get_thread_num();
                         t.process(ctx_, sts[tid]);
@@ -402,9 +515,11 @@ namespace scool {
               int p = omp_get_num_threads();
 
               this->sts_.resize(p);
+              this->pushed_.resize(p);
 
               curr_.resize(p);
               next_.resize(p);
+              dfs_.resize(p);
 
               this->log().info(this->NAME_) << "ready with " << p << " threads" << std::endl;
           }
@@ -423,21 +538,49 @@ namespace scool {
           this->template m_init__<true>(std::begin(v), std::end(v), next_, st);
       } // init
 
+      // Function: depth_first
+      // Lets ctx.push() process a new task in place, depth first, instead of adding it
+      // to the next superstep, as long as the recursion in a thread is at most *depth* levels deep.
+      // 0 disables depth-first processing (default), see <simple_executor::depth_first>.
+      void depth_first(int depth) { for (auto& b : dfs_) b.limit(depth); }
+
+      bool restart(const std::string& name, const partitioner& /* pt */ = partitioner()) {
+          // taskloop spreads tasks over threads, and the partitioner is not needed
+          return this->m_restart__(name, [this](task_type&& t) { next_[0].push_back(std::move(t)); });
+      } // restart
+
 
       long long int step() {
           this->log().info(this->NAME_) << "processing " << this->ntasks_
                                         << " tasks, superstep " << this->iter_
                                         << "..." << std::endl;
+          auto t0 = std::chrono::steady_clock::now();
+
           std::swap(curr_, next_);
 
           this->iter_++;
 
           m_process__();
+          this->mx_.time_process = this->m_elapsed__(t0);
+
+          auto t1 = std::chrono::steady_clock::now();
           this->m_reduce_state__();
+          this->mx_.time_reduce = this->m_elapsed__(t1);
+
+          this->mx_.tasks_processed = this->ntasks_;
 
           this->ntasks_ = 0;
           for (auto& ts : next_) this->ntasks_ += ts.size();
 
+          this->m_tick_checkpoint__([this](archive::writer& ar) {
+              for (auto& ts : next_) impl::save_frames(ar, std::begin(ts), std::end(ts));
+          });
+
+          this->mx_.frontier_tasks = this->ntasks_;
+          this->mx_.frontier_bytes = this->ntasks_ * sizeof(task_type);
+
+          this->m_report_metrics__(t0);
+
           return this->ntasks_;
       } // step
 
@@ -447,9 +590,17 @@ namespace scool {
       using local_storage_type = std::vector<task_storage_type>;
 
       void m_process__() {
+          SCOOL_TRACE_SCOPE("process");
+          SCOOL_PERF_TEAM_SCOPE(this->mx_.hw_process);
+
           int p = curr_.size();
           state_type* sts = this->sts_.data();
 
+          if constexpr (has_priority<task_type>) {
+              #pragma omp parallel for
+              for (int i = 0; i < p; ++i) impl::sort_by_priority(std::begin(curr_[i]), std::end(curr_[i]));
+          }
+
           #pragma omp parallel default(none) shared(p, curr_, ctx_, sts)
           {
               #pragma omp single nowait
@@ -470,12 +621,26 @@ namespace scool {
           }
       } // m_process__
 
+      // processes t in place in thread tid, if its depth-first budget allows
+      bool m_dive__(const task_type& t, int tid) {
+          if (!dfs_[tid].enter()) return false;
+
+          task_type x = t;
+          x.process(ctx_, this->sts_[tid]);
+
+          dfs_[tid].leave();
+          return true;
+      } // m_dive__
+
       friend omp_context<omp_executor, true>;
       omp_context<omp_executor, true> ctx_;
 
       local_storage_type curr_;
       local_storage_type next_;
 
+      // per-thread depth-first budgets
+      std::vector<impl::dfs_budget> dfs_;
+
   }; // class omp_executor
 
 } // namespace scool
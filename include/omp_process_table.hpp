@@ -8,6 +8,7 @@
 #include <omp.h>
 
 #include "omp_process_view.hpp"
+#include "trace.hpp"
 
 template <typename Task, typename Hash, template <typename A> class Alloc = std::allocator>
 class omp_process_table {
@@ -63,6 +64,8 @@ public:
 
     void reconcile()
     {
+        SCOOL_TRACE_SCOPE("reconcile");
+
         //Merge all hash tables
 
         int p = 1;
@@ -102,6 +105,7 @@ public:
     }
 
     void lazy_clear(){
+        SCOOL_TRACE_SCOPE("lazy_clear");
         for (auto& v : omp_process_views_){
             v.lazy_clear();
         }
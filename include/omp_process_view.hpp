@@ -36,7 +36,7 @@ public:
     struct iterator {
         using iterator_category = std::forward_iterator_tag;
 
-        //using value_type = typename Base::value_type;
+        using value_type = typename std::remove_const_t<Base>::task_type;
 
         using reference = typename std::conditional_t<Const, const task_type&, task_type&>;
         using pointer = typename std::conditional_t<Const, const task_type*, task_type*>;
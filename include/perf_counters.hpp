@@ -0,0 +1,189 @@
+/***
+ *  $Id$
+ **
+ *  File: perf_counters.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include "metrics.hpp"
+
+// Hardware performance counters per executor phase, enabled by compiling with -DSCOOL_PERF on Linux.
+// Otherwise, the macros below expand to nothing.
+//
+// SCOOL_PERF_SCOPE(c)      - adds counters of the calling thread in the enclosing scope to <hw_counters> c.
+// SCOOL_PERF_TEAM_SCOPE(c) - adds counters of all threads of OpenMP team in the enclosing scope to c,
+//                            must be used outside of parallel region.
+//
+// Executors attribute cycles, instructions, cache misses and branch misses (user space only)
+// to the phases reported in <metrics>. Every thread opens its own group of counters with
+// perf_event_open(2) on first use. If the group cannot be opened, e.g., because of
+// /proc/sys/kernel/perf_event_paranoid or missing PMU in a virtual machine, counters remain 0.
+
+#if defined(SCOOL_PERF) && defined(__linux__)
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define SCOOL_PERF_CAT__(a, b) a##b
+#define SCOOL_PERF_VAR__(a, b) SCOOL_PERF_CAT__(a, b)
+
+#define SCOOL_PERF_SCOPE(c) scool::impl::perf_scope SCOOL_PERF_VAR__(scool_perf_scope_, __LINE__)(c)
+#define SCOOL_PERF_TEAM_SCOPE(c) scool::impl::perf_team_scope SCOOL_PERF_VAR__(scool_perf_scope_, __LINE__)(c)
+
+
+namespace scool::impl {
+
+  // group of counters of the calling thread, read at once
+  class perf_group {
+  public:
+      static const int N = 4;
+
+      perf_group() {
+          const std::uint64_t events[N] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+          for (int i = 0; i < N; ++i) {
+              perf_event_attr attr;
+              std::memset(&attr, 0, sizeof(attr));
+
+              attr.type = PERF_TYPE_HARDWARE;
+              attr.size = sizeof(attr);
+              attr.config = events[i];
+              attr.read_format = PERF_FORMAT_GROUP;
+              attr.disabled = (i == 0);
+              attr.exclude_kernel = 1;
+              attr.exclude_hv = 1;
+
+              // this thread, any CPU
+              fd_[i] = syscall(SYS_perf_event_open, &attr, 0, -1, (i == 0) ? -1 : fd_[0], 0);
+
+              if (fd_[i] < 0) {
+                  m_close__();
+                  return;
+              }
+          } // for i
+
+          ioctl(fd_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      } // perf_group
+
+      ~perf_group() { m_close__(); }
+
+      bool read(std::uint64_t* v) const {
+          if (fd_[0] < 0) return false;
+
+          // number of counters followed by their values
+          std::uint64_t buf[N + 1];
+          if (::read(fd_[0], buf, sizeof(buf)) != sizeof(buf)) return false;
+
+          std::memcpy(v, buf + 1, N * sizeof(std::uint64_t));
+          return true;
+      } // read
+
+      // adds the difference between the current values and v0 to c
+      void add_since(const std::uint64_t* v0, hw_counters& c) const {
+          std::uint64_t v[N];
+          if (!read(v)) return;
+
+          std::atomic_ref<long long int>(c.cycles).fetch_add(v[0] - v0[0], std::memory_order_relaxed);
+          std::atomic_ref<long long int>(c.instructions).fetch_add(v[1] - v0[1], std::memory_order_relaxed);
+          std::atomic_ref<long long int>(c.cache_misses).fetch_add(v[2] - v0[2], std::memory_order_relaxed);
+          std::atomic_ref<long long int>(c.branch_misses).fetch_add(v[3] - v0[3], std::memory_order_relaxed);
+      } // add_since
+
+      // values at the beginning of team scope
+      std::uint64_t mark[N] = { 0, 0, 0, 0 };
+      bool marked = false;
+
+  private:
+      perf_group(const perf_group&) = delete;
+      void operator=(const perf_group&) = delete;
+
+      void m_close__() {
+          for (auto& fd : fd_) {
+              if (fd >= 0) close(fd);
+              fd = -1;
+          }
+      } // m_close__
+
+      int fd_[N] = { -1, -1, -1, -1 };
+
+  }; // class perf_group
+
+  inline perf_group& thread_perf() {
+      thread_local perf_group g;
+      return g;
+  } // thread_perf
+
+  class perf_scope {
+  public:
+      explicit perf_scope(hw_counters& c) : c_(c) { ok_ = thread_perf().read(v0_); }
+
+      ~perf_scope() { if (ok_) thread_perf().add_since(v0_, c_); }
+
+  private:
+      perf_scope(const perf_scope&) = delete;
+      void operator=(const perf_scope&) = delete;
+
+      hw_counters& c_;
+      std::uint64_t v0_[perf_group::N];
+      bool ok_ = false;
+
+  }; // class perf_scope
+
+  // the team is assumed to run on the same threads until the scope ends,
+  // which holds for OpenMP thread pools with unchanged team size
+  class perf_team_scope {
+  public:
+      explicit perf_team_scope(hw_counters& c) : c_(c) {
+          #pragma omp parallel
+          {
+              auto& g = thread_perf();
+              g.marked = g.read(g.mark);
+          }
+      } // perf_team_scope
+
+      ~perf_team_scope() {
+          hw_counters& c = c_;
+
+          #pragma omp parallel
+          {
+              auto& g = thread_perf();
+              if (g.marked) g.add_since(g.mark, c);
+              g.marked = false;
+          }
+      } // ~perf_team_scope
+
+  private:
+      perf_team_scope(const perf_team_scope&) = delete;
+      void operator=(const perf_team_scope&) = delete;
+
+      hw_counters& c_;
+
+  }; // class perf_team_scope
+
+} // namespace scool::impl
+
+#else
+
+#define SCOOL_PERF_SCOPE(c) static_cast<void>(0)
+#define SCOOL_PERF_TEAM_SCOPE(c) static_cast<void>(0)
+
+#endif // SCOOL_PERF
+
+#endif // PERF_COUNTERS_HPP
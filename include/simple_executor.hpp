@@ -15,8 +15,17 @@
 #ifndef SIMPLE_EXECUTOR_HPP
 #define SIMPLE_EXECUTOR_HPP
 
+#include <chrono>
+#include <functional>
+#include <string>
+
+#include "checkpoint.hpp"
 #include "impl.hpp"
+#include "metrics.hpp"
 #include "partitioner.hpp"
+#include "perf_counters.hpp"
+#include "spill_store.hpp"
+#include "trace.hpp"
 
 #include "jaz/logger.hpp"
 
@@ -36,7 +45,16 @@ namespace scool {
       int iteration() const { return exec_.iteration(); }
 
       // take a task and add it to the execution environment
-      void push(const task_type& t) { impl::add_to<Unique>(exec_.next_, t); }
+      void push(const task_type& t) {
+          exec_.mx_.tasks_pushed++;
+
+          if constexpr (Unique) {
+              if (exec_.m_dive__(t)) return;
+          }
+
+          impl::add_to<Unique>(exec_.next_, t);
+          if (exec_.budget_ > 0) exec_.m_tick_spill__();
+      } // push
 
   private:
       simple_context(const simple_context&) = delete;
@@ -72,6 +90,8 @@ namespace scool {
       // Function: simple_executor
       simple_executor() : ctx_(*this) { }
 
+      ~simple_executor() { SCOOL_TRACE_WRITE(); }
+
       // Function: log
       jaz::Logger& log() { return log_; }
 
@@ -91,6 +111,63 @@ namespace scool {
           init(std::begin(v), std::end(v), st);
       } // init
 
+      // Function: checkpoint
+      // Enables checkpointing: every *interval* supersteps the current frontier,
+      // the global state and the iteration counter are written to file *name*.
+      // The file is replaced only once it has been completely written.
+      void checkpoint(const std::string& name, int interval) {
+          ckpt_name_ = name;
+          ckpt_interval_ = interval;
+      } // checkpoint
+
+      // Function: memory_budget
+      // Limits memory used by tasks created in a superstep to about *bytes*.
+      // Once the limit is exceeded, tasks are spilled in batches to scratch files in *dir*,
+      // and are streamed back, with read-ahead, when processed in the next superstep.
+      // With non-unique tasks, files are partitioned by task hash, and duplicates
+      // are merged one partition at a time. 0 means no limit (default).
+      void memory_budget(std::size_t bytes, const std::string& dir = "/tmp") {
+          budget_ = bytes;
+          spill_curr_.open(dir);
+          spill_next_.open(dir);
+      } // memory_budget
+
+      // Function: depth_first
+      // Lets ctx.push() process a new task in place, depth first, instead of adding it
+      // to the next superstep, as long as the recursion is at most *depth* levels deep.
+      // This bounds memory of tree search to O(depth) tasks on the stack, but processed
+      // tasks see the current iteration(). 0 disables depth-first processing (default).
+      void depth_first(int depth) requires Unique { dfs_.limit(depth); }
+
+      // Function: on_metrics
+      // Sets function called with <metrics> at the end of each superstep.
+      void on_metrics(std::function<void(const metrics&)> f) { sink_.callback(std::move(f)); }
+
+      // Function: metrics_file
+      // Writes <metrics> of each superstep to file *name*, as JSON Lines.
+      //
+      // Returns:
+      //   false if *name* could not be opened.
+      bool metrics_file(const std::string& name) { return sink_.open(name); }
+
+      // Function: restart
+      // Initializes executor from checkpoint *name* written by any executor.
+      // Use instead of <init>.
+      //
+      // Returns:
+      //   false if *name* is not a valid checkpoint.
+      bool restart(const std::string& name, const partitioner& /* pt */ = partitioner()) {
+          // all tasks stay in one queue, and the partitioner is not needed
+          long long int n = impl::load_checkpoint<task_type>(name, iter_, st_, [this](task_type&& t) {
+              impl::add_to<Unique>(curr_, t);
+          });
+
+          if (n < 0) return false;
+
+          log_.info("SimpleExecutor") << "restarted " << n << " tasks, superstep " << iter_ << std::endl;
+          return true;
+      } // restart
+
       // Function: iteration
       int iteration() const { return iter_; }
 
@@ -99,18 +176,48 @@ namespace scool {
 
       // Function: step
       long long int step() {
-          log_.info("SimpleExecutor") << "processing " << curr_.size() << " tasks, superstep " << iter_ << "..." << std::endl;
+          log_.info("SimpleExecutor") << "processing " << curr_.size() + spill_curr_.size() << " tasks, superstep " << iter_ << "..." << std::endl;
+
+          auto t0 = std::chrono::steady_clock::now();
+          long long int n = curr_.size() + spill_curr_.size();
 
           m_process_current__();
           st_.identity();
 
+          mx_.time_process = m_elapsed__(t0);
+
+          // spilled duplicates are merged only when processed
+          mx_.frontier_tasks = next_.size() + spill_next_.size();
+          mx_.frontier_bytes = next_.size() * sizeof(task_type);
+          if constexpr (!Unique) mx_.tasks_merged = (mx_.tasks_pushed - mx_.frontier_tasks) + (n - mx_.tasks_processed);
+
           // exchange the queue and clear for next superstep
           std::swap(curr_, next_);
           next_.clear();
+          spill_curr_.swap(spill_next_);
 
           iter_++;
 
-          return curr_.size();
+          if ((ckpt_interval_ > 0) && (iter_ % ckpt_interval_ == 0)) {
+              auto fill = [this](archive::writer& ar) {
+                  impl::save_frames(ar, std::begin(curr_), std::end(curr_));
+                  spill_curr_.copy_to(ar);
+              };
+              if (!impl::save_checkpoint(ckpt_name_, iter_, st_, fill)) {
+                  log_.error("SimpleExecutor") << "could not write checkpoint " << ckpt_name_ << std::endl;
+              }
+          }
+
+          mx_.iteration = iter_ - 1;
+          mx_.time_total = m_elapsed__(t0);
+
+          sink_.call(mx_);
+          if (sink_.is_open()) sink_.write(mx_);
+
+          mx_ = metrics{};
+
+          // with non-unique tasks spilled duplicates are not merged yet
+          return curr_.size() + spill_curr_.size();
       } // step
 
 
@@ -118,11 +225,99 @@ namespace scool {
       using task_storage_type = typename std::conditional_t<Unique, std::vector<task_type>, phmap::node_hash_set<task_type>>;
 
       void m_process_current__() {
-          for (auto it = std::begin(curr_), end = std::end(curr_); it != end; ++it) {
-              it->process(ctx_, st_);
+          SCOOL_TRACE_SCOPE("process");
+          SCOOL_PERF_SCOPE(mx_.hw_process);
+
+          if constexpr (!Unique) {
+              if (!spill_curr_.empty()) {
+                  m_process_spilled__();
+                  return;
+              }
+          }
+
+          impl::for_each_by_priority(curr_, [this](auto& t) { m_process_task__(t); });
+
+          if constexpr (Unique) {
+              spill_curr_.read(0, [this](std::vector<task_type>& T) {
+                  impl::for_each_by_priority(T, [this](auto& t) { m_process_task__(t); });
+              });
           }
       } // m_process_current__
 
+      template <typename Task>
+      void m_process_task__(Task& t) {
+          t.process(ctx_, st_);
+          mx_.tasks_processed++;
+      } // m_process_task__
+
+      static double m_elapsed__(std::chrono::steady_clock::time_point t0) {
+          return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      } // m_elapsed__
+
+      // processes t in place if depth-first budget allows
+      bool m_dive__(const task_type& t) {
+          if (!dfs_.enter()) return false;
+
+          task_type x = t;
+          m_process_task__(x);
+
+          dfs_.leave();
+          return true;
+      } // m_dive__
+
+      int m_spill_part__(const task_type& t) const { return std::hash<task_type>{}(t) % SPILL_PARTS; }
+
+      // duplicates are merged and processed one partition at a time,
+      // tasks still in memory are merged with their partition
+      void m_process_spilled__() {
+          SCOOL_TRACE_SCOPE("process_spilled");
+
+          for (int k = 0; k < SPILL_PARTS; ++k) {
+              task_storage_type S;
+
+              spill_curr_.read(k, [&S](std::vector<task_type>& T) {
+                  for (auto& t : T) impl::add_to<false>(S, t);
+              });
+
+              for (auto it = std::begin(curr_); it != std::end(curr_);) {
+                  if (m_spill_part__(*it) == k) {
+                      impl::add_to<false>(S, *it);
+                      curr_.erase(it++);
+                  } else ++it;
+              }
+
+              impl::for_each_by_priority(S, [this](auto& t) { m_process_task__(t); });
+          } // for k
+      } // m_process_spilled__
+
+      // spills next_ if it exceeds the budget
+      void m_tick_spill__() {
+          if (next_.size() * spill_next_.task_bytes() < budget_) return;
+
+          if constexpr (Unique) spill_next_.write(0, std::begin(next_), std::end(next_));
+          else {
+              std::vector<std::vector<task_type>> P(SPILL_PARTS);
+
+              while (!next_.empty()) {
+                  auto node = next_.extract(next_.begin());
+                  int k = m_spill_part__(node.value());
+
+                  P[k].push_back(std::move(node.value()));
+
+                  if (P[k].size() == SPILL_BATCH) {
+                      spill_next_.write(k, std::begin(P[k]), std::end(P[k]));
+                      P[k].clear();
+                  }
+              }
+
+              for (int k = 0; k < SPILL_PARTS; ++k) spill_next_.write(k, std::begin(P[k]), std::end(P[k]));
+          }
+
+          log_.debug("SimpleExecutor") << "spilled " << spill_next_.size() << " tasks" << std::endl;
+
+          next_.clear();
+      } // m_tick_spill__
+
       friend simple_context<simple_executor, Unique>;
       simple_context<simple_executor, Unique> ctx_;
 
@@ -132,6 +327,23 @@ namespace scool {
       task_storage_type curr_;
       task_storage_type next_;
 
+      std::string ckpt_name_;
+      int ckpt_interval_ = 0;
+
+      // the number of spill files with non-unique tasks, and tasks buffered per file
+      static const int SPILL_PARTS = Unique ? 1 : 16;
+      static const std::size_t SPILL_BATCH = 4096;
+
+      std::size_t budget_ = 0;
+
+      impl::spill_store<task_type> spill_curr_{SPILL_PARTS};
+      impl::spill_store<task_type> spill_next_{SPILL_PARTS};
+
+      impl::dfs_budget dfs_;
+
+      metrics mx_;
+      impl::metrics_sink sink_;
+
       jaz::Logger log_;
 
   }; // class simple_executor
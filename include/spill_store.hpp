@@ -0,0 +1,209 @@
+/***
+ *  $Id$
+ **
+ *  File: spill_store.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef SPILL_STORE_HPP
+#define SPILL_STORE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "archive.hpp"
+
+
+namespace scool {
+
+  namespace impl {
+
+    // out-of-core storage of tasks, split into partitions kept in scratch files,
+    // partitions are written in frames (the same as in task exchange and checkpoints),
+    // and are streamed back in batches, where the next batch is read while
+    // the current one is being processed
+    template <typename T>
+    class spill_store {
+    public:
+        explicit spill_store(int nparts = 1) : size_(nparts, 0), bytes_(nparts, 0), os_(nparts) { }
+
+        ~spill_store() { m_remove__(); }
+
+        // sets directory with scratch files, must be called before write
+        void open(const std::string& dir) {
+            m_remove__();
+
+            static std::atomic_int id{0};
+            prefix_ = dir + "/scool-spill-" + std::to_string(getpid()) + "-" + std::to_string(id++) + "-";
+        } // open
+
+        int nparts() const { return size_.size(); }
+
+        // the number of tasks in the store
+        long long int size() const { return std::accumulate(std::begin(size_), std::end(size_), 0LL); }
+
+        long long int size(int part) const { return size_[part]; }
+
+        bool empty() const { return (size() == 0); }
+
+        // average number of bytes per serialized task, sizeof(T) until something is written
+        std::size_t task_bytes() const {
+            long long int n = size();
+            return (n == 0) ? sizeof(T) : (std::accumulate(std::begin(bytes_), std::end(bytes_), std::size_t(0)) / n);
+        } // task_bytes
+
+        // appends [first, last) to partition part
+        template <typename Iter>
+        void write(int part, Iter first, Iter last) {
+            if (first == last) return;
+
+            if (!os_[part].is_open()) {
+                os_[part].open(m_name__(part), std::ios::binary | std::ios::trunc);
+                if (!os_[part]) throw std::runtime_error("could not open spill file " + m_name__(part));
+            }
+
+            std::vector<char> buf;
+            archive::writer ar(buf);
+
+            while (first != last) {
+                auto it = first;
+                for (int i = 0; (i < FRAME) && (it != last); ++i, ++it) size_[part]++;
+                archive::save_range(ar, first, it);
+                first = it;
+            }
+
+            os_[part].write(buf.data(), buf.size());
+            if (!os_[part]) throw std::runtime_error("could not write spill file " + m_name__(part));
+
+            bytes_[part] += buf.size();
+        } // write
+
+        // streams partition part in batches, calling f(std::vector<T>&) on each,
+        // and removes the partition
+        template <typename Fun>
+        void read(int part, Fun f) {
+            if (size_[part] == 0) return;
+
+            os_[part].close();
+
+            std::ifstream is(m_name__(part), std::ios::binary);
+            if (!is) throw std::runtime_error("could not open spill file " + m_name__(part));
+
+            auto load = [&is]() {
+                std::vector<T> batch;
+                std::vector<char> buf;
+
+                archive::size_type n = 0;
+
+                while ((buf.size() < BATCH) && is.read(reinterpret_cast<char*>(&n), sizeof(n))) {
+                    auto pos = buf.size();
+                    buf.resize(pos + sizeof(n) + n);
+                    std::memcpy(buf.data() + pos, &n, sizeof(n));
+                    is.read(buf.data() + pos + sizeof(n), n);
+                }
+
+                archive::reader ar(buf);
+                while (!ar.empty()) archive::load_range(ar, batch);
+
+                return batch;
+            }; // load
+
+            auto next = std::async(std::launch::async, load);
+
+            do {
+                auto batch = next.get();
+                if (batch.empty()) break;
+
+                // read ahead
+                next = std::async(std::launch::async, load);
+                f(batch);
+            } while (true);
+
+            is.close();
+            std::remove(m_name__(part).c_str());
+
+            size_[part] = 0;
+            bytes_[part] = 0;
+        } // read
+
+        // streams all partitions, see read
+        template <typename Fun>
+        void read_all(Fun f) {
+            for (int i = 0; i < nparts(); ++i) read(i, f);
+        } // read_all
+
+        // appends raw frames of all partitions to ar, without changing the store
+        void copy_to(archive::writer& ar) {
+            for (int i = 0; i < nparts(); ++i) {
+                if (size_[i] == 0) continue;
+
+                os_[i].flush();
+                std::ifstream is(m_name__(i), std::ios::binary | std::ios::ate);
+
+                std::vector<char> buf(is.tellg());
+                is.seekg(0);
+                is.read(buf.data(), buf.size());
+
+                ar.write(buf.data(), buf.size());
+            }
+        } // copy_to
+
+        void swap(spill_store& other) {
+            std::swap(prefix_, other.prefix_);
+            std::swap(size_, other.size_);
+            std::swap(bytes_, other.bytes_);
+            std::swap(os_, other.os_);
+        } // swap
+
+    private:
+        spill_store(const spill_store&) = delete;
+        void operator=(const spill_store&) = delete;
+
+        std::string m_name__(int part) const { return prefix_ + std::to_string(part) + ".bin"; }
+
+        void m_remove__() {
+            for (int i = 0; i < nparts(); ++i) {
+                if (os_[i].is_open()) os_[i].close();
+                if (size_[i] > 0) std::remove(m_name__(i).c_str());
+                size_[i] = 0;
+                bytes_[i] = 0;
+            }
+        } // m_remove__
+
+        // the number of tasks per frame
+        static const int FRAME = 1024;
+
+        // the number of bytes per batch
+        static const std::size_t BATCH = 1 << 24;
+
+        std::string prefix_;
+
+        std::vector<long long int> size_;
+        std::vector<std::size_t> bytes_;
+
+        std::vector<std::ofstream> os_;
+
+    }; // class spill_store
+
+  } // namespace impl
+
+} // namespace scool
+
+#endif // SPILL_STORE_HPP
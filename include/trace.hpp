@@ -0,0 +1,241 @@
+/***
+ *  $Id$
+ **
+ *  File: trace.hpp
+ *  Created: Oct 16, 2026
+ *
+ *  Author: Jaroslaw Zola <jaroslaw.zola@hush.com>
+ *  Copyright (c) 2026 SCoRe Group
+ *  Distributed under the MIT License.
+ *  See accompanying file LICENSE.
+ *
+ *  This file is part of SCoOL.
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// Tracing of executor phases, enabled by compiling with -DSCOOL_TRACE.
+// Otherwise, the macros below expand to nothing.
+//
+// SCOOL_TRACE_SCOPE(name)  - records the enclosing scope as region *name* (string literal).
+// SCOOL_TRACE_THREAD(name) - names the calling thread (string literal).
+// SCOOL_TRACE_RANK(rank)   - sets the process id of the trace, MPI executors set it to their rank.
+// SCOOL_TRACE_WRITE()      - writes the trace, executors call it when destroyed.
+//
+// Every thread records regions in its own ring buffer of SCOOL_TRACE_BUFFER events,
+// which keeps the most recent ones. The buffers are written in Chrome trace format
+// (chrome://tracing, Perfetto) to file <prefix>.<rank>.json, see scool::trace::output(),
+// when an executor is destroyed and again at exit.
+
+#ifdef SCOOL_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifndef SCOOL_TRACE_BUFFER
+#define SCOOL_TRACE_BUFFER (1 << 16)
+#endif
+
+#define SCOOL_TRACE_CAT__(a, b) a##b
+#define SCOOL_TRACE_VAR__(a, b) SCOOL_TRACE_CAT__(a, b)
+
+#define SCOOL_TRACE_SCOPE(s) scool::trace::scope SCOOL_TRACE_VAR__(scool_trace_scope_, __LINE__)(s)
+#define SCOOL_TRACE_THREAD(s) scool::trace::thread_name(s)
+#define SCOOL_TRACE_RANK(r) scool::trace::rank(r)
+#define SCOOL_TRACE_WRITE() scool::trace::write()
+
+
+namespace scool::trace {
+
+  namespace impl {
+
+    inline std::uint64_t now() {
+        auto t = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t).count();
+    } // now
+
+    struct event {
+        const char* name;
+        std::uint64_t t0;
+        std::uint64_t t1;
+    }; // struct event
+
+    // written only by its thread, the oldest events are overwritten
+    // n_ publishes events to the thread that writes the trace
+    class ring_buffer {
+    public:
+        explicit ring_buffer(int tid) : tid_(tid), E_(SCOOL_TRACE_BUFFER) { }
+
+        void add(const char* name, std::uint64_t t0, std::uint64_t t1) {
+            auto n = n_.load(std::memory_order_relaxed);
+            E_[n % E_.size()] = {name, t0, t1};
+            n_.store(n + 1, std::memory_order_release);
+        } // add
+
+        void name(const char* name) { name_.store(name, std::memory_order_release); }
+
+        std::uint64_t dropped() const {
+            auto n = n_.load(std::memory_order_acquire);
+            return (n > E_.size()) ? n - E_.size() : 0;
+        } // dropped
+
+        void write(std::ostream& os, int pid, bool& first) const {
+            const char* name = name_.load(std::memory_order_acquire);
+
+            if (name != nullptr) {
+                os << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+                   << ",\"tid\":" << tid_ << ",\"args\":{\"name\":\"" << name << "\"}}";
+                first = false;
+            }
+
+            // snapshot of published events, the owner may keep recording meanwhile
+            auto n = n_.load(std::memory_order_acquire);
+            std::uint64_t pos = (n > E_.size()) ? n - E_.size() : 0;
+
+            std::vector<event> E;
+            E.reserve(n - pos);
+
+            for (std::uint64_t i = pos; i < n; ++i) E.push_back(E_[i % E_.size()]);
+
+            // events the owner could have overwritten during the copy are discarded
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto m = n_.load(std::memory_order_relaxed);
+            std::uint64_t valid = (m + 1 > E_.size()) ? m + 1 - E_.size() : 0;
+
+            for (std::uint64_t i = std::max(pos, valid); i < n; ++i) {
+                const auto& e = E[i - pos];
+                os << (first ? "" : ",\n") << "{\"ph\":\"X\",\"name\":\"" << e.name << "\",\"pid\":" << pid
+                   << ",\"tid\":" << tid_ << ",\"ts\":";
+                m_write_us__(os, e.t0);
+                os << ",\"dur\":";
+                m_write_us__(os, e.t1 - e.t0);
+                os << "}";
+                first = false;
+            }
+        } // write
+
+    private:
+        // Chrome trace uses microseconds
+        static void m_write_us__(std::ostream& os, std::uint64_t ns) {
+            os << (ns / 1000) << '.' << std::setw(3) << std::setfill('0') << (ns % 1000) << std::setfill(' ');
+        } // m_write_us__
+
+        int tid_;
+        std::atomic<const char*> name_{nullptr};
+
+        std::vector<event> E_;
+        std::atomic<std::uint64_t> n_{0};
+
+    }; // class ring_buffer
+
+    // owns buffers of all threads, so that they outlive threads, and writes them at exit
+    class registry {
+    public:
+        ~registry() { write(); }
+
+        ring_buffer* attach() {
+            std::lock_guard<std::mutex> lock(mtx_);
+            B_.push_back(std::make_unique<ring_buffer>(B_.size()));
+            return B_.back().get();
+        } // attach
+
+        void rank(int r) { rank_ = r; }
+
+        void output(const std::string& prefix) { prefix_ = prefix; }
+
+        // threads may be still recording, their events in flight are not written
+        void write() {
+            std::lock_guard<std::mutex> lock(mtx_);
+            std::ofstream of(prefix_ + "." + std::to_string(rank_) + ".json");
+            if (!of) return;
+
+            std::uint64_t dropped = 0;
+            bool first = true;
+
+            of << "{\"traceEvents\":[\n";
+
+            of << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << rank_
+               << ",\"args\":{\"name\":\"rank " << rank_ << "\"}}";
+            first = false;
+
+            for (const auto& b : B_) {
+                b->write(of, rank_, first);
+                dropped += b->dropped();
+            }
+
+            of << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+        } // write
+
+    private:
+        std::mutex mtx_;
+        std::vector<std::unique_ptr<ring_buffer>> B_;
+
+        int rank_ = 0;
+        std::string prefix_{"scool_trace"};
+
+    }; // class registry
+
+    inline registry& global() {
+        static registry reg;
+        return reg;
+    } // global
+
+    inline ring_buffer& local() {
+        thread_local ring_buffer* buf = global().attach();
+        return *buf;
+    } // local
+
+  } // namespace impl
+
+
+  // Class: scope
+  // Records its lifetime as a region, use via SCOOL_TRACE_SCOPE.
+  class scope {
+  public:
+      explicit scope(const char* name) : name_(name), t0_(impl::now()) { }
+
+      ~scope() { impl::local().add(name_, t0_, impl::now()); }
+
+  private:
+      scope(const scope&) = delete;
+      void operator=(const scope&) = delete;
+
+      const char* name_;
+      std::uint64_t t0_;
+
+  }; // class scope
+
+  // Function: rank
+  inline void rank(int r) { impl::global().rank(r); }
+
+  // Function: output
+  // Sets prefix of the trace file (default: scool_trace).
+  inline void output(const std::string& prefix) { impl::global().output(prefix); }
+
+  // Function: thread_name
+  inline void thread_name(const char* name) { impl::local().name(name); }
+
+  // Function: write
+  inline void write() { impl::global().write(); }
+
+} // namespace scool::trace
+
+#else
+
+#define SCOOL_TRACE_SCOPE(s) static_cast<void>(0)
+#define SCOOL_TRACE_THREAD(s) static_cast<void>(0)
+#define SCOOL_TRACE_RANK(r) static_cast<void>(0)
+#define SCOOL_TRACE_WRITE() static_cast<void>(0)
+
+#endif // SCOOL_TRACE
+
+#endif // TRACE_HPP
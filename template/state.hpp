@@ -52,6 +52,22 @@ public:
     // The routine is critical as it enables efficient distribution of the global state.
     void operator==(const State& st) const;
 
+    // Function: bound
+    // Optional. Returns a scalar bound used for pruning, e.g., the cost of the best
+    // solution found so far. Smaller values are better. If provided together with
+    // <bound(v)>, <mpi_executor> can propagate bound between ranks during superstep
+    // (see <mpi_config::incumbent_channel>).
+    bound_type bound() const;
+
+    // Function: bound
+    // Optional. Tightens the bound used for pruning to *v* found by some other rank.
+    // The solution corresponding to *v* is not available, and it will be delivered
+    // via the standard reduction at the end of superstep.
+    //
+    // Parameters:
+    // v - New bound, must be arithmetic type.
+    void bound(bound_type v);
+
 }; // class State
 
 
@@ -76,4 +92,23 @@ std::ostream& operator<<(std::ostream& os, const State& st);
 // st - Object to deserialize into.
 std::istream& operator>>(std::istream& is, State& st);
 
+// Function: operator<<
+// Optional state serialization into binary <scool::archive::writer>.
+// If provided, it is used by the runtime instead of the std::ostream
+// based routine.
+//
+// Parameters:
+// ar - Archive to store serialized object.
+// st - Object to serialize.
+scool::archive::writer& operator<<(scool::archive::writer& ar, const State& st);
+
+// Function: operator>>
+// Optional state deserialization from binary <scool::archive::reader>.
+// Must complement the corresponding <operator<<()>.
+//
+// Parameters:
+// ar - Archive to deserialize from.
+// st - Object to deserialize into.
+scool::archive::reader& operator>>(scool::archive::reader& ar, State& st);
+
 #endif // STATE_HPP
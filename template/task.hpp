@@ -53,6 +53,14 @@ public:
     // t - Object of *TaskType* model that should be merged with the calling task.
     void merge(const Task& t);
 
+    // Function: priority
+    // Optional. Returns an arithmetic priority of the task, e.g., its lower bound
+    // in minimization. Smaller values are better. If provided, executors process
+    // tasks of a superstep in the order of increasing priority, and stealing hands out
+    // tasks with the best priority first, so that the incumbent improves early
+    // and more of the remaining tasks can be pruned.
+    priority_type priority() const;
+
 }; // class Task
 
 // Function: operator==
@@ -67,6 +75,9 @@ bool operator==(const Task& t1, const Task& t2);
 // a persistent storage or to be sent over a network. It is recommended
 // that the routine is lightweight, and generates compact representation
 // of the object (e.g., without unnecessary decorations).
+// Trivially copyable tasks that do not provide archive operators are
+// serialized by copying their object representation, and this routine
+// is not used.
 //
 // Parameters:
 // os - Output stream to store serialized object.
@@ -82,6 +93,26 @@ std::ostream& operator<<(std::ostream& os, const Task& t);
 // t  - Object to deserialize into.
 std::istream& operator>>(std::istream& is, Task& t);
 
+// Function: operator<<
+// Optional task serialization into binary <scool::archive::writer>.
+// If provided, it is used by the runtime instead of the std::ostream
+// based routine. The archive supports bulk writes via *write(ptr, n)*,
+// and has operators for arithmetic types and their vectors.
+//
+// Parameters:
+// ar - Archive to store serialized object.
+// t  - Object to serialize.
+scool::archive::writer& operator<<(scool::archive::writer& ar, const Task& t);
+
+// Function: operator>>
+// Optional task deserialization from binary <scool::archive::reader>.
+// Must be provided together with, and complement, the corresponding <operator<<()>.
+//
+// Parameters:
+// ar - Archive to deserialize from.
+// t  - Object to deserialize into.
+scool::archive::reader& operator>>(scool::archive::reader& ar, Task& t);
+
 
 // Namespace: C++ Standard Namespace
 namespace std {